@@ -0,0 +1,32 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/bench/bench_utils.h"
+
+#include <random>
+
+namespace bench {
+
+  std::vector<std::string> synthetic_words(std::size_t num_words, int max_length) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> length(2, max_length);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> words;
+    while(words.size() < num_words) {
+      std::string word(length(rng), 'a');
+      for(char& c : word)
+        c = letter(rng);
+      words.push_back(word);
+    }
+    return words;
+  }
+
+  Counts zipf_counts(const std::vector<std::string>& words) {
+    Counts counts;
+    counts.reserve(words.size());
+    for(const std::string& word : words)
+      counts.emplace_back(word, 1000000000 / (counts.size() + 1));
+    return counts;
+  }
+
+} /* bench */
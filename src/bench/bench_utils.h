@@ -0,0 +1,27 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_BENCH_UTILS_H
+#define KEYBOARD_SWIPING_BENCH_UTILS_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Inputs shared by the benchmarks
+namespace bench {
+
+  typedef std::vector<std::pair<std::string, std::size_t>> Counts;
+
+  // Random lower case words of 2 to `max_length` letters. The same
+  //  arguments always give the same words.
+  std::vector<std::string> synthetic_words(std::size_t num_words, int max_length = 12);
+
+  // Counts following Zipf's law, as in natural text: the i-th word is seen
+  //  1/i times as often as the first
+  Counts zipf_counts(const std::vector<std::string>& words);
+
+} /* bench */
+
+#endif /* end of include guard: KEYBOARD_SWIPING_BENCH_UTILS_H */
@@ -0,0 +1,87 @@
+// Juliana Pacheco
+// University of Florida
+
+// Times Swipe::complete on the prefixes typed on the way to dictionary
+//  words, drawn in proportion to their counts as a user would type them,
+//  from a synthetic dictionary or a word,count CSV such as
+//  rcs/unigram_freq.csv. Fails (exit status 1) when the 99th percentile
+//  latency is above LIMIT_US microseconds, so it can gate changes.
+//
+// usage: complete_bench [COMPLETIONS] [LIMIT_US] [WORDS_CSV]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "src/bench/bench_utils.h"
+#include "src/swipe_prediction.h"
+#include "src/tools/tool_utils.h"
+
+namespace {
+
+const std::size_t NUM_QUERIES = 20000;
+
+// Every prefix a user types before picking `word`, the empty one included
+void typed_prefixes(const std::string& word, std::vector<std::string>& out) {
+  for(std::size_t i = 0; i < word.size(); i++)
+    out.push_back(word.substr(0, i));
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  const std::size_t completions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+  const double limit_us = argc > 2 ? std::atof(argv[2]) : 100.0;
+
+  bench::Counts words;
+  try {
+    words = argc > 3 ? tools::read_counts(argv[3])
+          : bench::zipf_counts(bench::synthetic_words(300000, 14));
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return -1;
+  }
+  if(words.empty()) {
+    std::cerr << "no words to complete\n";
+    return -1;
+  }
+  Swipe swipe(words.cbegin(), words.cend());
+
+  std::vector<double> weights;
+  for(const auto& word : words)
+    weights.push_back(word.second);
+  std::mt19937 rng(7);
+  std::discrete_distribution<std::size_t> pick(weights.cbegin(), weights.cend());
+  std::vector<std::string> prefixes;
+  while(prefixes.size() < NUM_QUERIES)
+    typed_prefixes(words[pick(rng)].first, prefixes);
+
+  std::vector<double> latencies;
+  latencies.reserve(prefixes.size());
+  std::size_t returned = 0;
+  for(const std::string& prefix : prefixes) {
+    auto start = std::chrono::steady_clock::now();
+    Swipe::Suggestions result = swipe.complete(prefix, completions);
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    latencies.push_back(elapsed.count());
+    returned += result.size();
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  const double p99 = tools::percentile(latencies, 0.99);
+  std::cout << "queries:     " << latencies.size() << " (top " << completions << ", "
+            << (double) returned / latencies.size() << " returned on average)\n"
+            << "p50:         " << tools::percentile(latencies, 0.5) << " us\n"
+            << "p99:         " << p99 << " us\n"
+            << "p999:        " << tools::percentile(latencies, 0.999) << " us\n"
+            << "max:         " << latencies.back() << " us\n";
+  if(p99 > limit_us) {
+    std::cerr << "p99 above the " << limit_us << " us target\n";
+    return 1;
+  }
+  return 0;
+}
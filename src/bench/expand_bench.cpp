@@ -0,0 +1,71 @@
+// Juliana Pacheco
+// University of Florida
+
+// Times Swipe::advance over long gestures of wide key sets on a synthetic
+//  dictionary, expanding frontiers on the calling thread only and then on
+//  THREADS extra threads for every frontier of at least THRESHOLD nodes.
+//
+// usage: expand_bench [THREADS] [THRESHOLD] [REPETITIONS]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "src/bench/bench_utils.h"
+#include "src/swipe_prediction.h"
+
+namespace {
+
+// Key sets of four neighbouring letters, as a fast sloppy swipe produces
+std::vector<std::set<char>> synthetic_gesture(std::mt19937& rng, std::size_t length) {
+  std::uniform_int_distribution<int> letter('a', 'z' - 3);
+  std::vector<std::set<char>> gesture;
+  for(std::size_t i = 0; i < length; i++) {
+    char c = letter(rng);
+    gesture.push_back({ c, (char) (c + 1), (char) (c + 2), (char) (c + 3) });
+  }
+  return gesture;
+}
+
+double time_ms(Swipe& swipe, const std::vector<std::vector<std::set<char>>>& gestures,
+      int repetitions) {
+  std::chrono::duration<double, std::milli> total(0);
+  for(int r = 0; r < repetitions; r++) {
+    for(const auto& gesture : gestures) {
+      swipe.reset();
+      auto start = std::chrono::steady_clock::now();
+      for(const std::set<char>& keys : gesture)
+        swipe.advance(keys);
+      total += std::chrono::steady_clock::now() - start;
+    }
+  }
+  return total.count() / (repetitions * gestures.size());
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  const std::size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+  const std::size_t threshold = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+        : Swipe::DEFAULT_PARALLEL_THRESHOLD;
+  const int repetitions = argc > 3 ? std::atoi(argv[3]) : 3;
+
+  bench::Counts words = bench::zipf_counts(bench::synthetic_words(300000, 14));
+  Swipe swipe(words.cbegin(), words.cend());
+  std::mt19937 rng(7);
+  std::vector<std::vector<std::set<char>>> gestures;
+  for(int i = 0; i < 10; i++)
+    gestures.push_back(synthetic_gesture(rng, 12));
+
+  double serial = time_ms(swipe, gestures, repetitions);
+  swipe.set_parallel_expansion(threads, threshold);
+  double parallel = time_ms(swipe, gestures, repetitions);
+
+  std::cout << "serial:            " << serial << " ms per gesture\n"
+            << "parallel (" << threads << " + 1): " << parallel << " ms per gesture\n"
+            << "(threshold " << threshold << ", mean of "
+            << repetitions * gestures.size() << " gestures)\n";
+}
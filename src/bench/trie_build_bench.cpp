@@ -0,0 +1,60 @@
+// Juliana Pacheco
+// University of Florida
+
+// Compares building a Trie word by word with Trie::insert against the bulk
+//  Trie::assign, on the words of a CSV dictionary or on synthetic ones when
+//  no file (or "-") is given.
+//
+// usage: trie_build_bench [WORDS_CSV] [REPETITIONS]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "src/bench/bench_utils.h"
+#include "src/tools/tool_utils.h"
+#include "src/trie.h"
+
+namespace {
+
+template <class Build>
+double time_ms(int repetitions, Build build) {
+  std::chrono::duration<double, std::milli> total(0);
+  for(int i = 0; i < repetitions; i++) {
+    Trie trie;
+    auto start = std::chrono::steady_clock::now();
+    build(trie);
+    total += std::chrono::steady_clock::now() - start;
+  }
+  return total.count() / repetitions;
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> words;
+  if(argc > 1 && std::string(argv[1]) != "-") {
+    for(const auto& entry : tools::read_counts(argv[1]))
+      words.push_back(entry.first);
+  } else {
+    words = bench::synthetic_words(300000);
+  }
+  const int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+  std::vector<std::string> sorted = words;
+  std::sort(sorted.begin(), sorted.end());
+
+  double insert = time_ms(repetitions, [&words](Trie& trie) {
+    for(const std::string& word : words)
+      trie.insert(word);
+  });
+  double assign = time_ms(repetitions, [&words](Trie& trie) { trie.assign(words); });
+  double assign_sorted = time_ms(repetitions, [&sorted](Trie& trie) { trie.assign(sorted); });
+
+  std::cout << "words:           " << words.size() << '\n'
+            << "insert:          " << insert << " ms\n"
+            << "assign:          " << assign << " ms\n"
+            << "assign (sorted): " << assign_sorted << " ms\n"
+            << "(mean of " << repetitions << " runs)\n";
+}
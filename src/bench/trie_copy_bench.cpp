@@ -0,0 +1,53 @@
+// Juliana Pacheco
+// University of Florida
+
+// Times Trie(const Trie&) and Trie::contains on the unigram dictionary, or
+//  on a synthetic one when no file (or "-") is given.
+//
+// usage: trie_copy_bench [WORDS_CSV] [REPETITIONS]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "src/bench/bench_utils.h"
+#include "src/trie.h"
+
+int main(int argc, char* argv[]) {
+  Trie trie;
+  std::vector<std::string> words;
+  if(argc > 1 && std::string(argv[1]) != "-") {
+    std::unordered_map<std::string, std::size_t> freq;
+    read_file_with_frequency(trie, freq, argv[1], ',');
+    for(const auto& entry : freq)
+      words.push_back(entry.first);
+  } else {
+    words = bench::synthetic_words(300000);
+    for(const std::string& word : words)
+      trie.insert(word);
+  }
+  const int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  std::chrono::duration<double, std::milli> copy_time(0), lookup_time(0);
+  std::size_t copied = 0, found = 0;
+  for(int i = 0; i < repetitions; i++) {
+    auto start = std::chrono::steady_clock::now();
+    Trie copy(trie);
+    copy_time += std::chrono::steady_clock::now() - start;
+    copied += copy.size();
+
+    start = std::chrono::steady_clock::now();
+    for(const std::string& word : words)
+      found += trie.contains(word);
+    lookup_time += std::chrono::steady_clock::now() - start;
+  }
+
+  std::cout << "words:    " << trie.size() << '\n'
+            << "copy:     " << copy_time.count() / repetitions << " ms\n"
+            << "contains: " << lookup_time.count() * 1e6 / repetitions / words.size()
+            << " ns/word\n"
+            << "(mean of " << repetitions << " runs)\n";
+  return copied == trie.size() * repetitions && found == words.size() * repetitions ? 0 : 1;
+}
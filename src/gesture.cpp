@@ -0,0 +1,115 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/gesture.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace gesture {
+
+  namespace {
+
+    const char* const LAYOUT[] = { "qwertyuiop", "asdfghjkl", "zxcvbnm" };
+    const int ROWS = 3;
+    const int MAX_LETTERS = 10;
+
+  } /* anonymous */
+
+  // Integer arithmetic follows CanvasKeyboard._draw_keyboard; the space bar
+  //  takes the fourth row
+  Keyboard::Keyboard(int width, int height) {
+    const int padding = (int) (height * 0.03);
+    const int key_varea = height / (ROWS + 1);
+    const int key_harea = std::min(key_varea, width / MAX_LETTERS);
+    const int left_offset = width - key_harea * MAX_LETTERS;
+    if(key_harea <= 2 * padding || left_offset < 0)
+      throw std::invalid_argument("keyboard too small");
+
+    for(int y = 0; y < ROWS; y++) {
+      const int letters = std::char_traits<char>::length(LAYOUT[y]);
+      const int row_offset = (int) ((MAX_LETTERS - letters) * 0.3 * key_harea);
+      for(int x = 0; x < letters; x++) {
+        const int left = left_offset + row_offset + key_harea * x;
+        keys_.push_back({ LAYOUT[y][x],
+              (double) left + padding, (double) key_varea * y + padding,
+              (double) left + key_harea - padding, (double) key_varea * (y + 1) - padding });
+      }
+    }
+    reach_ = std::min(key_harea - 2 * padding, key_varea - 2 * padding) / 2; // key_delta
+  }
+
+  Point Keyboard::center(char c) const {
+    c = std::tolower((unsigned char) c);
+    for(const Key& key : keys_)
+      if(key.letter == c)
+        return { (key.left + key.right) / 2, (key.top + key.bottom) / 2 };
+    throw std::invalid_argument(std::string("no key for '") + c + '\'');
+  }
+
+  std::set<char> Keyboard::keys_at(Point p) const {
+    std::set<char> letters;
+    for(const Key& key : keys_)
+      if(p.x + reach_ >= key.left && p.x - reach_ <= key.right
+            && p.y + reach_ >= key.top && p.y - reach_ <= key.bottom)
+        letters.insert(key.letter);
+    return letters;
+  }
+
+  std::vector<std::set<char>> swipe(const Keyboard& keyboard,
+        const std::string& word,
+        std::mt19937& rng,
+        double jitter,
+        double step) {
+    std::vector<Point> stops;
+    char prev_c = (char) 0;
+    for(char c : word) {
+      c = std::tolower((unsigned char) c);
+      if(c != prev_c)
+        stops.push_back(keyboard.center(c));
+      prev_c = c;
+    }
+
+    std::vector<std::set<char>> key_sets;
+    std::normal_distribution<double> noise(0.0, jitter > 0.0 ? jitter : 1.0);
+    auto sample = [&](Point p) {
+      if(jitter > 0.0) {
+        p.x += noise(rng);
+        p.y += noise(rng);
+      }
+      std::set<char> letters = keyboard.keys_at(p);
+      if(!letters.empty() && (key_sets.empty() || key_sets.back() != letters))
+        key_sets.push_back(std::move(letters));
+    };
+
+    if(!stops.empty())
+      sample(stops.front());
+    for(std::size_t i = 1; i < stops.size(); i++) {
+      const Point& from = stops[i - 1];
+      const Point& to = stops[i];
+      const double length = std::hypot(to.x - from.x, to.y - from.y);
+      const int samples = std::max(1, (int) std::ceil(length / step));
+      for(int s = 1; s <= samples; s++) {
+        const double t = (double) s / samples;
+        sample({ from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t });
+      }
+    }
+    return key_sets;
+  }
+
+  std::string to_message(const std::vector<std::set<char>>& gesture) {
+    std::string message;
+    for(const std::set<char>& letters : gesture) {
+      message += std::to_string(letters.size()) + '\n';
+      for(char c : letters) {
+        message += c;
+        message += '\n';
+      }
+    }
+    message += "0\n";
+    return message;
+  }
+
+} /* gesture */
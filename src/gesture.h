@@ -0,0 +1,61 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_GESTURE_H
+#define KEYBOARD_SWIPING_GESTURE_H
+
+#include <cstddef>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Synthetic swipes over the on-screen keyboard drawn by src/keyboard.py,
+//  used to replay realistic key set streams without a user at the screen.
+namespace gesture {
+
+  struct Point {
+    double x;
+    double y;
+  };
+
+  // Key rectangles of CanvasKeyboard: same layout, canvas size, padding and
+  //  row offsets, so the key sets match what the Tk keyboard would send.
+  class Keyboard {
+  public:
+    Keyboard(int width = 850, int height = 378);
+
+    // Throws std::invalid_argument if `c` isn't a letter of the layout
+    Point center(char c) const;
+    // Letters whose key overlaps the square the Tk keyboard probes around
+    //  a pointer at `p` (CanvasKeyboard._get_letters)
+    std::set<char> keys_at(Point p) const;
+
+  private:
+    struct Key {
+      char letter;
+      double left, top, right, bottom;
+    };
+
+    std::vector<Key> keys_;
+    double reach_; // half side of the probed square
+  };
+
+  // Key sets sent while swiping `word`: the pointer moves in straight lines
+  //  between the centers of its letters, sampled every `step` pixels, and
+  //  every sample is displaced by gaussian noise of deviation `jitter`.
+  //  Consecutive equal key sets are sent once, as keyboard.py does.
+  //  The same `rng` state always yields the same gesture.
+  std::vector<std::set<char>> swipe(const Keyboard& keyboard,
+        const std::string& word,
+        std::mt19937& rng,
+        double jitter = 0.0,
+        double step = 5.0);
+
+  // Swipe protocol message for a gesture: every key set as a count
+  //  followed by its keys, then the `0` requesting suggestions.
+  std::string to_message(const std::vector<std::set<char>>& gesture);
+
+} /* gesture */
+
+#endif /* end of include guard: KEYBOARD_SWIPING_GESTURE_H */
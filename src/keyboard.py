@@ -7,6 +7,8 @@ __status__ = "Development"
 import tkinter as tk
 from tkinter import N,S,E,W
 import threading, queue
+import argparse
+import socket
 import subprocess
 from subprocess import PIPE
 
@@ -34,6 +36,25 @@ def get_first_keycode(strings : tuple) -> str:
             return s
     return ""
 
+class SocketPrediction:
+    """Connection to a `swipe --server` process, exposing the subset of the
+    subprocess.Popen interface used by the IO threads."""
+    def __init__(self, path : str):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.stdin = self.sock.makefile('w', encoding='UTF-8')
+        self.stdout = self.sock.makefile('r', encoding='UTF-8')
+        self.returncode = None
+
+    def poll(self):
+        return self.returncode
+
+    def wait(self):
+        if self.returncode is None:
+            self.returncode = 0
+            self.sock.shutdown(socket.SHUT_RDWR)
+        return self.returncode
+
 g_keyswipe = queue.SimpleQueue()
 g_suggestions = queue.SimpleQueue()
 
@@ -238,7 +259,14 @@ class VKeyboard(tk.Frame):
 
 
 if __name__ == "__main__":
-    prediction = subprocess.Popen([f'./{BUILD_PATH}swipe'], stdin=PIPE, stdout=PIPE, encoding='UTF-8')
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--socket', help='connect to a running `swipe --server SOCKET`')
+    args = parser.parse_args()
+
+    if args.socket:
+        prediction = SocketPrediction(args.socket)
+    else:
+        prediction = subprocess.Popen([f'./{BUILD_PATH}swipe'], stdin=PIPE, stdout=PIPE, encoding='UTF-8')
     root = tk.Tk()
     root.title("Keyboard Swiping")
     app = VKeyboard(root)
@@ -0,0 +1,102 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_LRU_CACHE_H
+#define KEYBOARD_SWIPING_LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Bounded map which evicts the least recently used entry once `capacity`
+//  is reached. A capacity of 0 disables the cache entirely.
+template <typename Key, typename Value, class Hash = std::hash<Key>>
+class LRUCache {
+public:
+  typedef std::size_t size_type;
+
+  struct Stats {
+    size_type hits = 0;
+    size_type misses = 0;
+
+    size_type lookups() const { return hits + misses; }
+    double hit_rate() const {
+      return lookups() == 0 ? 0.0 : static_cast<double>(hits) / lookups();
+    }
+  };
+
+  explicit LRUCache(size_type capacity = 0) : capacity_(capacity) {}
+
+  bool empty() const { return entries_.empty(); }
+  size_type size() const { return entries_.size(); }
+  size_type capacity() const { return capacity_; }
+  void set_capacity(size_type capacity);
+
+  // Returns nullptr on miss. The pointer is valid until the next
+  //  modification of the cache.
+  const Value* find(const Key& key);
+  void insert(const Key& key, Value value);
+  void clear() { entries_.clear(); index_.clear(); }
+
+  const Stats& stats() const { return stats_; }
+  void reset_stats() { stats_ = Stats(); }
+
+private:
+  typedef std::list<std::pair<Key, Value>> list_type;
+
+  void evict_to(size_type max_size);
+
+  size_type capacity_;
+  list_type entries_; // most recently used first
+  std::unordered_map<Key, typename list_type::iterator, Hash> index_;
+  Stats stats_;
+};
+
+template <typename Key, typename Value, class Hash>
+void LRUCache<Key, Value, Hash>::set_capacity(size_type capacity) {
+  capacity_ = capacity;
+  evict_to(capacity_);
+}
+
+template <typename Key, typename Value, class Hash>
+const Value* LRUCache<Key, Value, Hash>::find(const Key& key) {
+  if(capacity_ == 0)
+    return nullptr;
+
+  auto it = index_.find(key);
+  if(it == index_.end()) {
+    stats_.misses++;
+    return nullptr;
+  }
+  stats_.hits++;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->second;
+}
+
+template <typename Key, typename Value, class Hash>
+void LRUCache<Key, Value, Hash>::insert(const Key& key, Value value) {
+  if(capacity_ == 0)
+    return;
+
+  auto it = index_.find(key);
+  if(it != index_.end()) {
+    it->second->second = std::move(value);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  evict_to(capacity_ - 1);
+  entries_.emplace_front(key, std::move(value));
+  index_[key] = entries_.begin();
+}
+
+template <typename Key, typename Value, class Hash>
+void LRUCache<Key, Value, Hash>::evict_to(size_type max_size) {
+  while(entries_.size() > max_size) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+#endif /* end of include guard: KEYBOARD_SWIPING_LRU_CACHE_H */
@@ -0,0 +1,316 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/shared_dictionary.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "src/utils.h"
+
+using Node = SharedDictionary::Node;
+using Word = SharedDictionary::Word;
+
+struct SharedDictionary::Header {
+  char magic[8];
+  std::uint32_t version;
+  std::atomic<std::uint32_t> ready; // set once the creator finished writing
+  std::uint64_t length;
+  std::uint64_t num_words;
+  std::uint64_t num_nodes;
+  std::uint64_t root; // relative to the start of the segment
+};
+
+namespace {
+
+const char MAGIC[8] = { 'S', 'W', 'I', 'P', 'E', 'D', 'I', 'C' };
+const std::uint32_t VERSION = 3;
+const auto READY_TIMEOUT = std::chrono::seconds(10);
+const auto READY_POLL = std::chrono::milliseconds(10);
+
+std::system_error errno_error(const std::string& what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+template <typename T>
+const T* follow(const void* from, std::int64_t offset) {
+  return reinterpret_cast<const T*>(static_cast<const char*>(from) + offset);
+}
+
+std::int64_t relative(const void* from, const void* to) {
+  return static_cast<const char*>(to) - static_cast<const char*>(from);
+}
+
+std::size_t align(std::size_t size) {
+  return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+}
+
+} /* anonymous */
+
+SharedDictionary SharedDictionary::create(const std::string& name,
+      const Trie& trie,
+      const std::unordered_map<std::string,std::size_t>& frequencies) {
+  // Nodes are numbered in depth first order
+  std::vector<const Trie::Node*> nodes;
+  std::size_t num_words = 0, num_chars = 0;
+  for(auto it = trie.dfs_begin(); it != trie.dfs_end(); ++it) {
+    nodes.push_back(&*it);
+    num_words += it->get_words().size();
+    for(std::string_view s : it->get_words())
+      num_chars += s.size();
+  }
+  std::unordered_map<const Trie::Node*, std::size_t> index;
+  for(std::size_t i = 0; i < nodes.size(); i++)
+    index[nodes[i]] = i;
+
+  const std::size_t nodes_at = align(sizeof(Header));
+  const std::size_t edges_at = nodes_at + align(nodes.size() * sizeof(Node));
+  const std::size_t words_at = edges_at + align((nodes.size() - 1) * sizeof(Edge));
+  const std::size_t chars_at = words_at + align(num_words * sizeof(Word));
+  const std::size_t length = chars_at + num_chars;
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if(fd < 0)
+    throw errno_error("shm_open " + name);
+  if(ftruncate(fd, length) < 0) {
+    std::system_error error = errno_error("ftruncate " + name);
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw error;
+  }
+  void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(address == MAP_FAILED) {
+    std::system_error error = errno_error("mmap " + name);
+    ::close(fd);
+    shm_unlink(name.c_str());
+    throw error;
+  }
+
+  char* base = static_cast<char*>(address);
+  Node* out_nodes = reinterpret_cast<Node*>(base + nodes_at);
+  Edge* out_edge = reinterpret_cast<Edge*>(base + edges_at);
+  Word* out_word = reinterpret_cast<Word*>(base + words_at);
+  char* out_char = base + chars_at;
+
+  for(std::size_t i = 0; i < nodes.size(); i++) {
+    const Trie::Node* node = nodes[i];
+    Node* out = out_nodes + i;
+    out->num_words_ = node->get_words().size();
+    out->words_ = relative(out, out_word);
+    for(std::string_view s : node->get_words()) {
+      auto freq = frequencies.find(utils::to_lower(s));
+      out_word->rank_ = utils::frequency_rank((freq == frequencies.cend()) ? 0 : freq->second);
+      out_word->length_ = s.size();
+      out_word->reserved_ = 0;
+      out_word->text_ = relative(out_word, out_char);
+      std::memcpy(out_char, s.data(), s.size());
+      out_char += s.size();
+      out_word++;
+    }
+
+    out->num_children_ = 0;
+    out->best_rank_ = 0;
+    out->runs_ = Trie::Runs();
+    out->reserved_ = 0;
+    out->children_ = relative(out, out_edge);
+    node->do_on_children([&](char c, const Trie::Node* child) {
+      std::memset(out_edge, 0, sizeof(Edge));
+      out_edge->key = c;
+      out_edge->child = relative(out_edge, out_nodes + index.at(child));
+      out_edge++;
+      out->num_children_++;
+    });
+  }
+
+  // Children come after their parent, so a backward pass sees them first
+  for(std::size_t i = nodes.size(); i-- > 0;) {
+    Node* out = out_nodes + i;
+    for(const Word* w = out->words_begin(); w != out->words_end(); ++w) {
+      out->best_rank_ = std::max(out->best_rank_, w->rank());
+      Trie::Runs runs = Trie::runs_of(w->view());
+      out->runs_.doubled |= runs.doubled;
+      out->runs_.single |= runs.single;
+    }
+    out->do_on_children([out](char, const Node* child) {
+      out->best_rank_ = std::max(out->best_rank_, child->best_rank());
+      out->runs_.doubled |= child->runs_.doubled;
+      out->runs_.single |= child->runs_.single;
+    });
+  }
+
+  Header* header = new (address) Header();
+  std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+  header->version = VERSION;
+  header->length = length;
+  header->num_words = trie.size();
+  header->num_nodes = nodes.size();
+  header->root = nodes_at;
+  header->ready.store(1, std::memory_order_release);
+  munmap(address, length);
+
+  // Hand out the same read-only view as attaching processes get
+  address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(address == MAP_FAILED)
+    throw errno_error("mmap " + name);
+  return SharedDictionary(address, length);
+}
+
+SharedDictionary SharedDictionary::attach(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if(fd < 0)
+    throw errno_error("shm_open " + name);
+
+  // The creator may still be sizing or writing the segment
+  const auto deadline = std::chrono::steady_clock::now() + READY_TIMEOUT;
+  struct stat info;
+  while(true) {
+    if(fstat(fd, &info) < 0) {
+      std::system_error error = errno_error("fstat " + name);
+      ::close(fd);
+      throw error;
+    }
+    if((std::size_t) info.st_size >= sizeof(Header))
+      break;
+    if(std::chrono::steady_clock::now() > deadline) {
+      ::close(fd);
+      throw std::runtime_error("shared dictionary " + name + " was never initialised");
+    }
+    std::this_thread::sleep_for(READY_POLL);
+  }
+
+  std::size_t length = info.st_size;
+  void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(address == MAP_FAILED)
+    throw errno_error("mmap " + name);
+  SharedDictionary dict(address, length);
+
+  const Header& header = dict.header();
+  while(header.ready.load(std::memory_order_acquire) == 0) {
+    if(std::chrono::steady_clock::now() > deadline)
+      throw std::runtime_error("shared dictionary " + name + " was never initialised");
+    std::this_thread::sleep_for(READY_POLL);
+  }
+  if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != VERSION
+        || header.length != length)
+    throw std::runtime_error(name + " is not a compatible shared dictionary");
+  return dict;
+}
+
+bool SharedDictionary::exists(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if(fd >= 0) {
+    ::close(fd);
+    return true;
+  }
+  if(errno == ENOENT)
+    return false;
+  throw errno_error("shm_open " + name);
+}
+
+void SharedDictionary::remove(const std::string& name) {
+  if(shm_unlink(name.c_str()) < 0)
+    throw errno_error("shm_unlink " + name);
+}
+
+SharedDictionary::SharedDictionary(SharedDictionary&& rhs)
+      : address_(rhs.address_), length_(rhs.length_) {
+  rhs.address_ = nullptr;
+  rhs.length_ = 0;
+}
+
+SharedDictionary& SharedDictionary::operator=(SharedDictionary&& rhs) {
+  if(this != &rhs) {
+    if(address_ != nullptr)
+      munmap(const_cast<void*>(address_), length_);
+    address_ = rhs.address_;
+    length_ = rhs.length_;
+    rhs.address_ = nullptr;
+    rhs.length_ = 0;
+  }
+  return *this;
+}
+
+SharedDictionary::~SharedDictionary() {
+  if(address_ != nullptr)
+    munmap(const_cast<void*>(address_), length_);
+}
+
+SharedDictionary::size_type SharedDictionary::size() const {
+  return header().num_words;
+}
+
+const Node* SharedDictionary::root() const {
+  return follow<Node>(address_, header().root);
+}
+
+const Node* SharedDictionary::find(const std::string& word) const {
+  if(!Trie::word_is_valid(word))
+    return nullptr;
+
+  const Node* current = root();
+  char prev_c = (char) 0;
+  for(char c : word) {
+    if(std::isalpha((unsigned char) c) && prev_c != c) {
+      c = std::tolower((unsigned char) c);
+      current = current->get_child(c);
+      if(current == nullptr)
+        return nullptr;
+      prev_c = c;
+    }
+  }
+  return current;
+}
+
+bool SharedDictionary::contains(const std::string& word) const {
+  const Node* node = find(word);
+  return node != nullptr && node->contains_word(word);
+}
+
+const SharedDictionary::Header& SharedDictionary::header() const {
+  return *static_cast<const Header*>(address_);
+}
+
+const char* Word::data() const {
+  return follow<char>(this, text_);
+}
+
+bool Node::contains_word(const std::string& word) const {
+  for(const Word* w = words_begin(); w != words_end(); ++w)
+    if(w->size() == word.size() && std::memcmp(w->data(), word.data(), w->size()) == 0)
+      return true;
+  return false;
+}
+
+const Word* Node::words_begin() const {
+  return follow<Word>(this, words_);
+}
+
+const SharedDictionary::Edge* Node::edges_begin() const {
+  return follow<Edge>(this, children_);
+}
+
+const Node* Node::get_child(char c) const {
+  c = std::tolower((unsigned char) c);
+  const Edge* begin = edges_begin();
+  const Edge* end = begin + num_children_;
+  const Edge* edge = std::lower_bound(begin, end, c,
+        [](const Edge& e, char key) { return e.key < key; });
+  if(edge == end || edge->key != c)
+    return nullptr;
+  return follow<Node>(edge, edge->child);
+}
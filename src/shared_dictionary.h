@@ -0,0 +1,146 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_SHARED_DICTIONARY_H
+#define KEYBOARD_SWIPING_SHARED_DICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include "src/trie.h"
+
+// Read-only image of a Trie and its word frequencies laid out in a POSIX
+//  shared memory segment. The image only stores offsets relative to the
+//  record holding them, so every process may map it at any address and
+//  all of them share a single physical copy.
+//
+// Note: Functions throw std::system_error when the segment can't be
+//  created or mapped, and std::runtime_error when it isn't a valid image.
+class SharedDictionary {
+public:
+  class Node;
+  class Word;
+  typedef std::size_t size_type;
+
+  // Writes `trie` into a new segment called `name` (e.g. "/swipe-en"),
+  //  which outlives the process until `remove` is called.
+  static SharedDictionary create(const std::string& name, const Trie& trie,
+        const std::unordered_map<std::string,std::size_t>& frequencies);
+  static SharedDictionary attach(const std::string& name);
+  static bool exists(const std::string& name);
+  // Attaches to `name`, calling `build` to fill and create the segment if
+  //  it doesn't exist yet. Safe when several processes start at once.
+  template <class Build>
+  static SharedDictionary open(const std::string& name, Build build);
+  static void remove(const std::string& name);
+
+  SharedDictionary(SharedDictionary&& rhs);
+  SharedDictionary& operator=(SharedDictionary&& rhs);
+  SharedDictionary(const SharedDictionary&) = delete;
+  SharedDictionary& operator=(const SharedDictionary&) = delete;
+  ~SharedDictionary();
+
+  bool empty() const { return size() == 0; }
+  size_type size() const;
+  size_type bytes() const { return length_; }
+
+  const Node* root() const;
+  const Node* find(const std::string& word) const;
+  bool contains(const std::string& word) const;
+
+private:
+  struct Header;
+  struct Edge;
+
+  SharedDictionary(const void* address, size_type length)
+        : address_(address), length_(length) {}
+  const Header& header() const;
+
+  const void* address_;
+  size_type length_;
+};
+
+class SharedDictionary::Word {
+public:
+  const char* data() const;
+  size_type size() const { return length_; }
+  std::string str() const { return std::string(data(), size()); }
+  std::string_view view() const { return std::string_view(data(), size()); }
+  // Quantised frequency (see utils::frequency_rank)
+  Trie::rank_type rank() const { return rank_; }
+
+private:
+  friend class SharedDictionary;
+
+  std::int64_t text_; // relative to this record
+  std::uint32_t length_;
+  Trie::rank_type rank_;
+  std::uint16_t reserved_;
+};
+
+struct SharedDictionary::Edge {
+  std::int64_t child; // relative to this record
+  char key;
+  char reserved[7];
+};
+
+// Mirrors the read-only part of Trie::Node
+class SharedDictionary::Node {
+public:
+  bool has_words() const { return num_words_ != 0; }
+  bool contains_word(const std::string& word) const;
+  const Word* words_begin() const;
+  const Word* words_end() const { return words_begin() + num_words_; }
+
+  bool has_children() const { return num_children_ != 0; }
+  bool contains_child(char c) const { return get_child(c) != nullptr; }
+  const Node* get_child(char c) const;
+  template <class Func> void do_on_children(Func&& func) const;
+
+  // As in Trie::Node, computed when the image is created
+  Trie::rank_type best_rank() const { return best_rank_; }
+  Trie::Runs runs() const { return runs_; }
+
+private:
+  friend class SharedDictionary;
+
+  const Edge* edges_begin() const;
+
+  std::uint16_t num_children_;
+  Trie::rank_type best_rank_;
+  std::uint32_t num_words_;
+  std::int64_t children_; // relative to this record
+  std::int64_t words_;    // relative to this record
+  Trie::Runs runs_;
+  std::uint32_t reserved_;
+};
+
+template <class Func>
+void SharedDictionary::Node::do_on_children(Func&& func) const {
+  const Edge* begin = edges_begin();
+  for(const Edge* edge = begin; edge != begin + num_children_; ++edge)
+    func(edge->key, reinterpret_cast<const Node*>(
+          reinterpret_cast<const char*>(edge) + edge->child));
+}
+
+template <class Build>
+SharedDictionary SharedDictionary::open(const std::string& name, Build build) {
+  if(exists(name))
+    return attach(name);
+
+  Trie trie;
+  std::unordered_map<std::string,std::size_t> frequencies;
+  build(trie, frequencies);
+  try {
+    return create(name, trie, frequencies);
+  } catch(const std::system_error& e) {
+    if(e.code() != std::errc::file_exists)
+      throw;
+    return attach(name); // another process created it meanwhile
+  }
+}
+
+#endif /* end of include guard: KEYBOARD_SWIPING_SHARED_DICTIONARY_H */
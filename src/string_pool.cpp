@@ -0,0 +1,52 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/string_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+StringPool::StringPool(std::size_t chunk_size)
+      : chunk_size_(std::max<std::size_t>(chunk_size, 1)),
+        used_(0), available_(0), size_(0), capacity_(0) {
+}
+
+std::string_view StringPool::add(std::string_view str) {
+  if(str.empty())
+    return std::string_view();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(str.size() > available_)
+    grow(str.size());
+  char* out = chunks_.back().get() + used_;
+  std::memcpy(out, str.data(), str.size());
+  used_ += str.size();
+  available_ -= str.size();
+  size_ += str.size();
+  return std::string_view(out, str.size());
+}
+
+void StringPool::reserve(std::size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(bytes > available_)
+    grow(bytes);
+}
+
+std::size_t StringPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+std::size_t StringPool::capacity() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+// The rest of the last chunk is abandoned
+void StringPool::grow(std::size_t bytes) {
+  std::size_t size = std::max(bytes, chunk_size_);
+  chunks_.emplace_back(new char[size]);
+  used_ = 0;
+  available_ = size;
+  capacity_ += size;
+}
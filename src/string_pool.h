@@ -0,0 +1,46 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_STRING_POOL_H
+#define KEYBOARD_SWIPING_STRING_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Append-only storage for many short strings, e.g. the words of a
+//  dictionary. Strings are copied back to back into large chunks, which
+//  are never moved or freed before the pool, so the returned views stay
+//  valid for the pool's whole lifetime. Adding strings is thread safe.
+class StringPool {
+public:
+  static const std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+  explicit StringPool(std::size_t chunk_size = DEFAULT_CHUNK_SIZE);
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  // Returns the pooled copy of `str`
+  std::string_view add(std::string_view str);
+  // Makes the next `bytes` bytes of strings land in a single chunk
+  void reserve(std::size_t bytes);
+
+  // Bytes of strings stored / allocated
+  std::size_t size() const;
+  std::size_t capacity() const;
+
+private:
+  void grow(std::size_t bytes);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  std::size_t chunk_size_;
+  std::size_t used_;      // in the last chunk
+  std::size_t available_; // left in the last chunk
+  std::size_t size_;
+  std::size_t capacity_;
+};
+
+#endif /* end of include guard: KEYBOARD_SWIPING_STRING_POOL_H */
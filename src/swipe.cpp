@@ -1,21 +1,96 @@
 // Juliana Pacheco
 // University of Florida
 
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
+#include "src/shared_dictionary.h"
 #include "src/swipe_prediction.h"
+#include "src/swipe_server.h"
 
 const char* unigram = "rcs/unigram_freq.csv";
 const unsigned int num_of_suggestions = 4;
 
-int main() {
+namespace {
+
+SwipeServer* g_server = nullptr;
+
+void stop_server(int) {
+  if(g_server != nullptr)
+    g_server->stop();
+}
+
+int usage(const char* name) {
+  std::cerr << "usage: " << name << " [--shm NAME] [--server SOCKET_PATH [--workers N]]"
+            << " [--expand-threads N]\n"
+            << "       " << name << " --shm-remove NAME\n";
+  return -1;
+}
+
+// With a shared memory name, the first process builds the dictionary and
+//  every other one maps that same copy
+std::unique_ptr<Swipe> make_swipe(const std::string& shm_name) {
+  if(shm_name.empty())
+    return std::unique_ptr<Swipe>(new Swipe(unigram));
+  return std::unique_ptr<Swipe>(new Swipe(SharedDictionary::open(shm_name,
+        [](Trie& trie, FrequencyMap& freq) {
+    read_file_with_frequency(trie, freq, unigram, ','); // CSV
+  })));
+}
+
+int serve(const Swipe& swipe, const std::string& path, std::size_t workers) {
+  SwipeServer server(swipe, path, workers, num_of_suggestions);
+  g_server = &server;
+  std::signal(SIGINT, stop_server);
+  std::signal(SIGTERM, stop_server);
+  std::cout << "READY" << std::endl;
+  server.run();
+  g_server = nullptr;
+  return 0;
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  std::string socket_path, shm_name, shm_remove;
+  std::size_t workers = std::thread::hardware_concurrency();
+  std::size_t expand_threads = 0;
+  for(int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if(arg == "--server" && i + 1 < argc)
+      socket_path = argv[++i];
+    else if(arg == "--shm" && i + 1 < argc)
+      shm_name = argv[++i];
+    else if(arg == "--shm-remove" && i + 1 < argc)
+      shm_remove = argv[++i];
+    else if(arg == "--workers" && i + 1 < argc)
+      workers = std::strtoul(argv[++i], nullptr, 10);
+    else if(arg == "--expand-threads" && i + 1 < argc)
+      expand_threads = std::strtoul(argv[++i], nullptr, 10);
+    else
+      return usage(argv[0]);
+  }
+
   try {
-    Swipe swipe(unigram);
+    if(!shm_remove.empty()) {
+      SharedDictionary::remove(shm_remove);
+      return 0;
+    }
+
+    std::unique_ptr<Swipe> swipe_ptr = make_swipe(shm_name);
+    Swipe& swipe = *swipe_ptr;
+    swipe.set_parallel_expansion(expand_threads);
+    if(!socket_path.empty())
+      return serve(swipe, socket_path, workers);
+
     std::cout << "READY" << std::endl;
 
     int code_or_num;
-    std::vector<std::string> suggestions;
+    Swipe::Suggestions suggestions;
     std::set<char> keys;
     char key;
     while(true) {
@@ -23,8 +98,8 @@ int main() {
       if(code_or_num < 0)
         break;
       if(code_or_num == 0) {
-        suggestions = std::move(swipe.get(num_of_suggestions));
-        for(const std::string& s : suggestions)
+        suggestions = swipe.get(num_of_suggestions);
+        for(std::string_view s : suggestions)
           std::cout << s << '\n';
         // Assure that `num_of_suggestions` messages are always sent
         for(std::size_t i = suggestions.size(); i < num_of_suggestions; i++)
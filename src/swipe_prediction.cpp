@@ -5,29 +5,284 @@
 
 #include <algorithm>
 #include <cctype>
-#include <functional>
+#include <cstdint>
 #include <queue>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include "src/trie.h"
 #include "src/utils.h"
 
+namespace {
+
+struct Candidate {
+  std::string_view text;
+  Trie::rank_type rank;
+};
+
+// Frontier nodes handed to a thread at a time by a parallel expansion
+const std::size_t EXPANSION_CHUNK = 256;
+
+template <class NodeT>
+using Extensions = std::vector<std::pair<char, const NodeT*>>;
+
+template <class NodeT>
+void extend(const NodeT* node, char characteristic_letter,
+      const std::set<char>& letters, Extensions<NodeT>& out) {
+  for(char c : letters) {
+    if(c == characteristic_letter)
+      continue;
+    const NodeT* child = node->get_child(c);
+    if(child != nullptr)
+      out.push_back({ c, child });
+  }
+}
+
+// Shared by both dictionary representations. `NodeT` must provide
+//  `contains_child` and `get_child`. Frontiers of at least `threshold`
+//  nodes are split into chunks that the threads of `pool` (if any) claim
+//  as they become free, each writing to a buffer of its own.
+template <class Space, class NodeT>
+void expand(Space& solution_space, const NodeT* root, const std::set<char>& letters,
+      ThreadPool* pool, std::size_t threshold) {
+  if(solution_space.empty()) {
+    for(char c : letters) {
+      if(root->contains_child(c))
+        solution_space[c].insert(root->get_child(c));
+    }
+    return;
+  }
+
+  std::size_t frontier_size = 0;
+  for(auto it = solution_space.cbegin(); it != solution_space.cend(); ++it)
+    frontier_size += it->second.size();
+
+  // Use of temporary storage avoids iterator invalidation
+  std::vector<Extensions<NodeT>> found;
+  if(pool == nullptr || frontier_size < threshold) {
+    found.resize(1);
+    for(auto it = solution_space.cbegin(); it != solution_space.cend(); ++it)
+      for(const NodeT* node : it->second)
+        extend(node, it->first, letters, found.front());
+  } else {
+    // Flattened so that a chunk is a range of indices
+    Extensions<NodeT> frontier;
+    frontier.reserve(frontier_size);
+    for(auto it = solution_space.cbegin(); it != solution_space.cend(); ++it)
+      for(const NodeT* node : it->second)
+        frontier.push_back({ it->first, node });
+
+    found.resize(pool->size() + 1);
+    std::size_t num_chunks = (frontier.size() + EXPANSION_CHUNK - 1) / EXPANSION_CHUNK;
+    pool->parallel_for(num_chunks, [&](std::size_t chunk, std::size_t slot) {
+      std::size_t end = std::min(frontier.size(), (chunk + 1) * EXPANSION_CHUNK);
+      for(std::size_t i = chunk * EXPANSION_CHUNK; i < end; i++)
+        extend(frontier[i].second, frontier[i].first, letters, found[slot]);
+    });
+  }
+
+  // Buffers are merged once every thread is done, so no locks are needed
+  for(const Extensions<NodeT>& extensions : found)
+    for(const auto& extension : extensions)
+      solution_space[extension.first].insert(extension.second);
+}
+
+template <class Space, class Visit>
+void for_each_node(const Space& solution_space, const std::set<char>& letters, Visit visit) {
+  for(char c : letters) {
+    auto bucket = solution_space.find(c);
+    if(bucket != solution_space.cend())
+      for(auto node : bucket->second)
+        visit(node);
+  }
+}
+
+template <class Func>
+void do_on_words(const Trie::Node* node, Func&& func) {
+  const std::vector<std::string_view>& words = node->get_words();
+  for(std::size_t i = 0; i < words.size(); i++)
+    func(words[i], node->get_ranks()[i]);
+}
+
+template <class Func>
+void do_on_words(const SharedDictionary::Node* node, Func&& func) {
+  for(auto w = node->words_begin(); w != node->words_end(); ++w)
+    func(w->view(), w->rank());
+}
+
+// Runs some word below a node must have to start with `prefix`: those of
+//  `prefix`, except that its last letter may repeat further in the word.
+//  Past 16 positions the last one isn't known, so the 16th is let go too.
+Trie::Runs runs_needed(std::string_view prefix) {
+  Trie::Runs runs = Trie::runs_of(prefix);
+  runs.single &= (runs.doubled | runs.single) >> 1;
+  return runs;
+}
+
+bool may_match(const Trie::Runs& below, const Trie::Runs& needed) {
+  return (needed.doubled & ~below.doubled) == 0 && (needed.single & ~below.single) == 0;
+}
+
+bool starts_with(std::string_view word, std::string_view prefix) {
+  if(word.size() < prefix.size())
+    return false;
+  for(std::size_t i = 0; i < prefix.size(); i++)
+    if(std::tolower((unsigned char) word[i]) != std::tolower((unsigned char) prefix[i]))
+      return false;
+  return true;
+}
+
+// Every word starting with `prefix` lies below `node`, the node of its
+//  collapsed key, along with words that only share the collapsed key
+//  (e.g. "helo" below "hell"). The search is best first: a node enters
+//  the queue with its best_rank, the highest rank below it, so words come
+//  out in rank order and subtrees that can't reach the last completion
+//  are never opened. At equal ranks queued words go first. Subtrees whose
+//  Runs rule out the prefix (e.g. no word below "h" starts with "hh") are
+//  never queued.
+template <class NodeT>
+Swipe::Suggestions complete(const NodeT* node, const std::string& prefix,
+      std::size_t max_completions) {
+  struct Entry {
+    Trie::rank_type rank;
+    const NodeT* node; // nullptr for a word
+    std::string_view text;
+  };
+  auto after = [](const Entry& a, const Entry& b) {
+    if(a.rank != b.rank)
+      return a.rank < b.rank;
+    if((a.node == nullptr) != (b.node == nullptr))
+      return a.node != nullptr;
+    return a.text > b.text;
+  };
+  std::priority_queue<Entry, std::vector<Entry>, decltype(after)> queue(after);
+
+  Swipe::Suggestions completions;
+  const Trie::Runs needed = runs_needed(prefix);
+  if(node == nullptr || max_completions == 0 || !may_match(node->runs(), needed))
+    return completions;
+  queue.push({ node->best_rank(), node, {} });
+  while(!queue.empty()) {
+    Entry entry = queue.top();
+    queue.pop();
+    if(entry.node == nullptr) {
+      completions.push_back(entry.text);
+      if(completions.size() == max_completions)
+        break;
+      continue;
+    }
+    do_on_words(entry.node, [&](std::string_view word, Trie::rank_type rank) {
+      if(starts_with(word, prefix))
+        queue.push({ rank, nullptr, word });
+    });
+    entry.node->do_on_children([&](char, const NodeT* child) {
+      if(may_match(child->runs(), needed))
+        queue.push({ child->best_rank(), child, {} });
+    });
+  }
+  return completions;
+}
+
+} /* anonymous */
+
 Swipe::Swipe(const char* filename) {
-  read_file_with_frequency(trie_, frequencies_, filename, ','); // CSV
+  load(filename);
 }
 
-Swipe::Swipe(const Trie& trie, const FrequencyMap& freq)
-      : trie_(trie), frequencies_(freq) {
+Swipe::Swipe(const Trie& trie, const FrequencyMap& freq) : trie_(trie) {
+  rank_words(freq);
 }
 
-const std::vector<std::string>& Swipe::insert(const std::string& word,
+Swipe::Swipe(const Swipe& base)
+      : trie_(base.trie_), updates_(base.updates_), shared_(base.shared_),
+        expansion_pool_(base.expansion_pool_),
+        parallel_threshold_(base.parallel_threshold_) {
+  std::lock_guard<std::mutex> lock(base.cache_mutex_);
+  cache_.set_capacity(base.cache_.capacity());
+}
+
+Swipe::Swipe(SharedDictionary&& dictionary)
+      : shared_(std::make_shared<const SharedDictionary>(std::move(dictionary))) {
+}
+
+void Swipe::load(const char* filename) {
+  if(shared_)
+    throw std::logic_error("cannot load into a shared dictionary");
+  reset();
+  clear_cache();
+
+  // Replaces the dictionary, including words and counts given to `insert`
+  trie_.clear();
+  updates_.clear();
+  FrequencyMap counts;
+  read_file_with_frequency(trie_, counts, filename, ','); // CSV
+  rank_words(counts);
+}
+
+void Swipe::rank_words(const FrequencyMap& frequencies) {
+  trie_.rank_words([&frequencies](std::string_view word, Trie::rank_type) {
+    auto freq = frequencies.find(utils::to_lower(word));
+    return utils::frequency_rank((freq == frequencies.cend()) ? 0 : freq->second);
+  });
+  trie_.cbegin()->best_rank(); // so the first completion isn't slower
+}
+
+const std::vector<std::string_view>& Swipe::insert(const std::string& word,
       std::size_t frequency) {
+  if(shared_)
+    throw std::logic_error("cannot insert into a shared dictionary");
   reset();
-  std::string lower = std::move(word);
-  frequencies_[lower] += frequency;
-  return trie_.insert(lower)->get_words();
+  clear_cache();
+  std::size_t count = this->frequency(word) + frequency;
+  updates_[word] = count;
+  // Known words only get their frequency bumped
+  Trie::iterator node = trie_.contains(word) ? trie_.find(word) : trie_.insert(word);
+  node->set_rank(word, utils::frequency_rank(count));
+  return node->get_words();
+}
+
+bool Swipe::contains(const std::string& word) const {
+  return shared_ ? shared_->contains(word) : trie_.contains(word);
+}
+
+// Lower case first: the trie only merges a repeated letter that is lower
+//  case, so "HELL" would otherwise walk to "hell" rather than "helo"
+Swipe::Suggestions Swipe::complete(const std::string& prefix,
+      std::size_t max_completions) const {
+  const std::string lower = utils::to_lower(prefix);
+  if(shared_)
+    return ::complete(shared_->find(lower), lower, max_completions);
+  return ::complete(trie_.find(lower).operator->(), lower, max_completions);
+}
+
+void Swipe::set_cache_capacity(std::size_t capacity) {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache_.set_capacity(capacity);
+}
+
+Swipe::CacheStats Swipe::cache_stats() const {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  return cache_.stats();
 }
 
-void Swipe::advance(const std::set<char>& candidate_letters) {
+void Swipe::set_parallel_expansion(std::size_t num_threads, std::size_t threshold) {
+  expansion_pool_ = num_threads > 0 ? std::make_shared<ThreadPool>(num_threads) : nullptr;
+  parallel_threshold_ = threshold;
+}
+
+void Swipe::clear_cache() {
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache_.clear();
+}
+
+void Swipe::Session::reset() {
+  solution_space_.clear();
+  shared_space_.clear();
+  previous_letters_.clear();
+  sequence_key_.clear();
+}
+
+void Swipe::Session::advance(const std::set<char>& candidate_letters) {
   if(candidate_letters.empty())
     return;
 
@@ -35,67 +290,109 @@ void Swipe::advance(const std::set<char>& candidate_letters) {
   for(char c : candidate_letters)
     letters.insert(std::tolower((unsigned char) c));
 
-  if(solution_space_.empty()) {
-    for(char c : letters) {
-      Trie::const_iterator root = trie_.cbegin();
-      if(root->contains_child(c))
-        solution_space_[c].insert(root->get_child(c));
-    }
-  } else {
-    // Use of temporary storage avoids iterator invalidation
-    std::queue<std::pair<char,const Trie::Node*>> to_add;
-
-    for(auto it = solution_space_.cbegin(); it != solution_space_.cend(); ++it) {
-      char characteristic_letter = it->first;
-      for(const Trie::Node* node : it->second)
-        for(char c : letters)
-          if(c != characteristic_letter && node->contains_child(c))
-            to_add.push({ c, node->get_child(c) });
-    }
+  // Letters are sorted, so equal key sets always produce the same key
+  sequence_key_.append(letters.cbegin(), letters.cend());
+  sequence_key_ += '|';
 
-    while(!to_add.empty()) {
-      char characteristic_letter = to_add.front().first;
-      const Trie::Node* new_node = to_add.front().second;
-      solution_space_[characteristic_letter].insert(new_node);
-      to_add.pop();
-    }
-  }
+  ThreadPool* pool = swipe_->expansion_pool_.get();
+  if(swipe_->shared_)
+    expand(shared_space_, swipe_->shared_->root(), letters, pool, swipe_->parallel_threshold_);
+  else
+    expand(solution_space_, swipe_->trie_.cbegin().operator->(), letters,
+          pool, swipe_->parallel_threshold_);
 
   previous_letters_ = std::move(letters);
 }
 
-std::vector<std::string> Swipe::get(std::size_t max_suggestions) const {
+Swipe::Suggestions Swipe::Session::get(std::size_t max_suggestions) const {
+  return swipe_->suggest(*this, max_suggestions);
+}
+
+Swipe::Suggestions Swipe::suggest(const Session& session,
+      std::size_t max_suggestions) const {
+  if(session.sequence_key_.empty())
+    return {};
+
+  const std::string key = session.sequence_key_ + std::to_string(max_suggestions);
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const Suggestions* cached = cache_.find(key);
+    if(cached != nullptr)
+      return *cached;
+  }
+
+  // Ranking runs unlocked so concurrent sessions don't serialise on it
+  Suggestions suggestions = rank(session, max_suggestions);
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache_.insert(key, suggestions);
+  return suggestions;
+}
+
+std::size_t Swipe::frequency(const std::string& word) const {
+  if(!updates_.empty()) {
+    auto update = updates_.find(word);
+    if(update != updates_.cend())
+      return update->second;
+  }
+  Trie::const_iterator node = trie_.find(word);
+  return node ? utils::rank_frequency(node->get_rank(word)) : 0;
+}
+
+// Candidates are scored once as 32-bit integers and the selected words
+//  are returned as views, without copying. Words of similar length
+//  compete on their frequency rank while much longer words win: lengths
+//  are grouped into tiers of `letter_dif + 1`, counted down from the
+//  longest candidate, and the tier forms the high bits of the score.
+Swipe::Suggestions Swipe::rank(const Session& session,
+      std::size_t max_suggestions) const {
   const std::size_t letter_dif = 2;
-  std::priority_queue<std::string,
-                      std::vector<std::string>,
-                      std::function<bool(const std::string&,const std::string&)>
-        >heap([&](const std::string& s1, const std::string& s2) {
-    if(std::max(s1.size(), s2.size()) - std::min(s1.size(), s2.size()) > letter_dif)
-      return s1.size() < s2.size();
-
-    std::string s1_lower = std::move(utils::to_lower(s1));
-    std::string s2_lower = std::move(utils::to_lower(s2));
-
-    std::size_t s1_freq = (frequencies_.find(s1_lower) == frequencies_.cend())
-        ? 0 : frequencies_.at(s1_lower);
-    std::size_t s2_freq = (frequencies_.find(s2_lower) == frequencies_.cend())
-        ? 0 : frequencies_.at(s2_lower);
-
-    return (s1_freq != s2_freq) ? (s1_freq < s2_freq) : (s1 < s2);
-  });
-  std::vector<std::string> suggestions;
+  const int rank_bits = 16;
+  const std::uint32_t max_tier = (std::uint32_t(1) << (32 - rank_bits)) - 1;
 
-  for(char c : previous_letters_) {
-    if(solution_space_.find(c) != solution_space_.cend())
-      for(const Trie::Node* node : solution_space_.at(c))
-        for(const std::string& s : node->get_words())
-          heap.push(s);
+  std::vector<Candidate> candidates;
+  if(shared_) {
+    for_each_node(session.shared_space_, session.previous_letters_,
+          [&candidates](const SharedDictionary::Node* node) {
+      for(auto w = node->words_begin(); w != node->words_end(); ++w)
+        candidates.push_back({ w->view(), w->rank() });
+    });
+  } else {
+    for_each_node(session.solution_space_, session.previous_letters_,
+          [&candidates](const Trie::Node* node) {
+      const std::vector<std::string_view>& words = node->get_words();
+      for(std::size_t i = 0; i < words.size(); i++)
+        candidates.push_back({ words[i], node->get_ranks()[i] });
+    });
   }
 
-  std::size_t out_size = std::min(max_suggestions, heap.size());
-  for(std::size_t i = 0; i < out_size; i++) {
-    suggestions.push_back(heap.top());
-    heap.pop();
+  std::size_t max_length = 0;
+  for(const Candidate& candidate : candidates)
+    max_length = std::max(max_length, candidate.text.size());
+
+  // (score, candidate id) pairs; larger scores rank first
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> scored;
+  scored.reserve(candidates.size());
+  for(std::uint32_t id = 0; id < candidates.size(); id++) {
+    const Candidate& candidate = candidates[id];
+    std::uint32_t tier = std::min<std::size_t>(
+          (max_length - candidate.text.size()) / (letter_dif + 1), max_tier);
+    scored.emplace_back(((max_tier - tier) << rank_bits) | candidate.rank, id);
   }
+
+  auto before = [&candidates](const std::pair<std::uint32_t, std::uint32_t>& a,
+                              const std::pair<std::uint32_t, std::uint32_t>& b) {
+    if(a.first != b.first)
+      return a.first > b.first;
+    return candidates[a.second].text > candidates[b.second].text;
+  };
+  std::size_t out_size = std::min(max_suggestions, scored.size());
+  if(out_size < scored.size())
+    std::nth_element(scored.begin(), scored.begin() + out_size, scored.end(), before);
+  std::sort(scored.begin(), scored.begin() + out_size, before);
+
+  Suggestions suggestions;
+  suggestions.reserve(out_size);
+  for(std::size_t i = 0; i < out_size; i++)
+    suggestions.push_back(candidates[scored[i].second].text);
   return suggestions;
 }
@@ -6,35 +6,118 @@
 
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
+#include "src/lru_cache.h"
+#include "src/shared_dictionary.h"
+#include "src/thread_pool.h"
 #include "src/trie.h"
 
 using FrequencyMap = std::unordered_map<std::string, std::size_t>;
 
 class Swipe {
 public:
+  typedef std::vector<std::string_view> Suggestions;
+  typedef LRUCache<std::string, Suggestions>::Stats CacheStats;
+  static const std::size_t DEFAULT_CACHE_CAPACITY = 1024;
+  static const std::size_t DEFAULT_PARALLEL_THRESHOLD = 4096;
+
   Swipe(const char* filename);
   Swipe(const std::string& filename) : Swipe(filename.c_str()) {}
   template <class InputIt> Swipe(InputIt begin, InputIt end);
   Swipe(const Trie& trie, const FrequencyMap& freq);
+  // Snapshot of `base`'s dictionary (e.g. to customise it for one user).
+  //  Unmodified trie nodes stay shared with `base`, so the copy costs
+  //  O(changes) rather than O(dictionary). Gesture state and cached
+  //  suggestions are not copied.
+  Swipe(const Swipe& base);
+  Swipe& operator=(const Swipe&) = delete;
+  // Predicts straight from a shared dictionary, which is read-only:
+  //  `load` and `insert` throw std::logic_error
+  explicit Swipe(SharedDictionary&& dictionary);
+
+  // Replaces the dictionary with the words and counts of a CSV file
+  void load(const char* filename);
+  void load(const std::string& filename) { load(filename.c_str()); }
+  const std::vector<std::string_view>& insert(const std::string& word, std::size_t frequency);
+  bool contains(const std::string& word) const;
+
+  // Tap typing: up to `max_completions` words starting with `prefix`
+  //  (ignoring case), most frequent first; words of the same rank come in
+  //  no particular order. Reads the same dictionary as the sessions, so it
+  //  returns the same views and may run alongside them.
+  Suggestions complete(const std::string& prefix, std::size_t max_completions) const;
+
+  // Gesture state of a single client. Sessions only read the dictionary, so
+  //  many of them may share one Swipe (and call `get` concurrently), but
+  //  they must be reset after the dictionary is modified.
+  //
+  // Suggestions are views of the dictionary's own copy of each word. They
+  //  stay valid until the Swipe is destroyed or `load` is called.
+  class Session {
+  public:
+    explicit Session(const Swipe& swipe) : swipe_(&swipe) {}
+
+    void reset();
+    void advance(const std::set<char>& candidate_letters);
+    Suggestions get(std::size_t max_suggestions
+          = std::numeric_limits<std::size_t>::max()) const;
 
-  const std::vector<std::string>& insert(const std::string& word, std::size_t frequency);
-  bool contains(const std::string& word) const { return trie_.contains(word); }
+  private:
+    friend class Swipe;
+    template <class NodeT>
+    using SolutionSpace = std::map<char, std::unordered_set<const NodeT*>>;
 
-  void reset() { solution_space_.clear(); previous_letters_.clear(); }
-  void advance(const std::set<char>& candidate_letters);
-  std::vector<std::string> get(std::size_t max_suggestions
-        = std::numeric_limits<std::size_t>::max()) const;
+    const Swipe* swipe_;
+    SolutionSpace<Trie::Node> solution_space_;
+    SolutionSpace<SharedDictionary::Node> shared_space_;
+    std::set<char> previous_letters_;
+    std::string sequence_key_;
+  };
+
+  void reset() { session_.reset(); }
+  void advance(const std::set<char>& candidate_letters) { session_.advance(candidate_letters); }
+  Suggestions get(std::size_t max_suggestions
+        = std::numeric_limits<std::size_t>::max()) const { return session_.get(max_suggestions); }
+
+  // Suggestions are cached by the sequence of key sets given to `advance`.
+  //  The cache is dropped whenever the dictionary changes.
+  void set_cache_capacity(std::size_t capacity);
+  CacheStats cache_stats() const;
+
+  // Lets `advance` expand frontiers of at least `threshold` nodes (summed
+  //  over all letters) on `num_threads` extra threads; smaller ones, the
+  //  common case, stay on the calling thread. 0 threads turns it off,
+  //  which is the default. Snapshots share the threads. Must not be called
+  //  while sessions are advancing.
+  void set_parallel_expansion(std::size_t num_threads,
+        std::size_t threshold = DEFAULT_PARALLEL_THRESHOLD);
 
 private:
+  void clear_cache();
+  Suggestions suggest(const Session& session, std::size_t max_suggestions) const;
+  Suggestions rank(const Session& session, std::size_t max_suggestions) const;
+  std::size_t frequency(const std::string& word) const;
+  void rank_words(const FrequencyMap& frequencies);
+
+  // Words only keep a 16-bit quantised frequency (Trie::rank_type), which
+  //  is all ranking needs. Exact counts are kept just for words changed by
+  //  `insert`, so that repeated small increments aren't lost to rounding.
   Trie trie_;
-  FrequencyMap frequencies_;
-  std::map<char, std::unordered_set<const Trie::Node*>> solution_space_;
-  std::set<char> previous_letters_;
+  FrequencyMap updates_;
+  std::shared_ptr<const SharedDictionary> shared_;
+  mutable std::mutex cache_mutex_;
+  mutable LRUCache<std::string, Suggestions> cache_{DEFAULT_CACHE_CAPACITY};
+  std::shared_ptr<ThreadPool> expansion_pool_;
+  std::size_t parallel_threshold_ = DEFAULT_PARALLEL_THRESHOLD;
+  Session session_{*this};
 };
 
 // Object pointed to by InputIt must have the following accessors:
@@ -42,10 +125,17 @@ private:
 //    | second (type unsigned int)
 template <class InputIt>
 Swipe::Swipe(InputIt begin, InputIt end) {
+  FrequencyMap frequencies;
+  std::vector<std::string> words;
   for(InputIt iter = begin; iter != end; ++iter) {
-    trie_.insert(iter->first);
-    frequencies_[iter->first] = iter->second;
+    auto entry = frequencies.emplace(iter->first, iter->second);
+    if(entry.second)
+      words.push_back(iter->first);
+    else
+      entry.first->second = iter->second;
   }
+  trie_.assign(words);
+  rank_words(frequencies);
 }
 
 #endif /* end of include guard: KEYBOARD_SWIPING_SWIPE_PREDICTION_H */
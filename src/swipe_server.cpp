@@ -0,0 +1,324 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/swipe_server.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int MAX_EVENTS = 64;
+const std::size_t READ_SIZE = 4096;
+
+std::system_error errno_error(const char* what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+void epoll_set(int epoll_fd, int op, int fd, std::uint32_t events) {
+  epoll_event ev;
+  std::memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.fd = fd;
+  if(epoll_ctl(epoll_fd, op, fd, &ev) < 0)
+    throw errno_error("epoll_ctl");
+}
+
+} /* anonymous */
+
+struct SwipeServer::Connection {
+  Connection(int fd, const Swipe& swipe) : fd(fd), session(swipe) {}
+
+  int fd;
+  Swipe::Session session;
+  std::string input;
+  std::string output;
+  std::set<char> keys;
+  long pending_keys = 0; // keys still expected for the current key set
+  bool busy = false;     // a `get` is being ranked on the worker pool
+  bool closing = false;  // client ended the session; close once answered
+  bool eof = false;      // client shut down its side; stop polling for input
+  bool closed = false;
+  std::uint32_t events = EPOLLIN;
+};
+
+SwipeServer::SwipeServer(const Swipe& swipe,
+      const std::string& socket_path,
+      std::size_t num_workers,
+      std::size_t num_suggestions)
+      : swipe_(swipe), path_(socket_path), num_suggestions_(num_suggestions),
+        listen_fd_(-1), epoll_fd_(-1), event_fd_(-1), stopping_(false) {
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(path_.empty() || path_.size() >= sizeof(addr.sun_path))
+    throw std::invalid_argument("invalid socket path '" + path_ + '\'');
+  std::memcpy(addr.sun_path, path_.c_str(), path_.size());
+
+  try {
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listen_fd_ < 0)
+      throw errno_error("socket");
+    unlink(path_.c_str()); // stale socket of a previous server
+    if(bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+      throw errno_error("bind");
+    if(listen(listen_fd_, SOMAXCONN) < 0)
+      throw errno_error("listen");
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(event_fd_ < 0)
+      throw errno_error("eventfd");
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd_ < 0)
+      throw errno_error("epoll_create1");
+    epoll_set(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+    epoll_set(epoll_fd_, EPOLL_CTL_ADD, event_fd_, EPOLLIN);
+  } catch(...) {
+    for(int fd : { listen_fd_, event_fd_, epoll_fd_ })
+      if(fd >= 0)
+        ::close(fd);
+    throw;
+  }
+  pool_.reset(new ThreadPool(num_workers));
+}
+
+SwipeServer::~SwipeServer() {
+  pool_.reset(); // finish outstanding work before the descriptors go away
+  for(auto& entry : connections_)
+    ::close(entry.first);
+  ::close(epoll_fd_);
+  ::close(event_fd_);
+  ::close(listen_fd_);
+  unlink(path_.c_str());
+}
+
+void SwipeServer::run() {
+  epoll_event events[MAX_EVENTS];
+  while(!stopping_) {
+    int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+    if(n < 0) {
+      if(errno == EINTR)
+        continue;
+      throw errno_error("epoll_wait");
+    }
+
+    for(int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if(fd == listen_fd_) {
+        accept_clients();
+      } else if(fd == event_fd_) {
+        collect_results();
+      } else {
+        auto it = connections_.find(fd);
+        if(it == connections_.end())
+          continue;
+        connection_ptr conn = it->second; // keep alive through close()
+        // A hang up after end of file means nobody is left to read answers
+        if((events[i].events & EPOLLERR) || ((events[i].events & EPOLLHUP) && conn->eof)) {
+          close(conn);
+          continue;
+        }
+        if(events[i].events & (EPOLLIN | EPOLLHUP)) {
+          read_from(conn);
+          process(conn);
+        }
+        flush(conn);
+      }
+    }
+  }
+}
+
+void SwipeServer::stop() {
+  stopping_ = true;
+  notify();
+}
+
+void SwipeServer::notify() {
+  std::uint64_t one = 1;
+  ssize_t written = write(event_fd_, &one, sizeof(one));
+  (void) written; // counter saturation still leaves the loop woken up
+}
+
+void SwipeServer::accept_clients() {
+  while(true) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if(fd < 0) {
+      if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return;
+      if(errno == ECONNABORTED)
+        continue;
+      throw errno_error("accept4");
+    }
+    connection_ptr conn = std::make_shared<Connection>(fd, swipe_);
+    connections_[fd] = conn;
+    epoll_set(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN);
+    conn->output = "READY\n";
+    flush(conn);
+  }
+}
+
+void SwipeServer::read_from(const connection_ptr& conn) {
+  char buffer[READ_SIZE];
+  while(!conn->closed) {
+    ssize_t n = read(conn->fd, buffer, sizeof(buffer));
+    if(n > 0) {
+      if(!conn->closing)
+        conn->input.append(buffer, n);
+    } else if(n == 0) {
+      // Answer the input already buffered before closing, as the standard
+      //  input protocol does at end of file
+      conn->eof = true;
+      conn->closing = true;
+      return;
+    } else if(errno == EINTR) {
+      continue;
+    } else {
+      if(errno != EAGAIN && errno != EWOULDBLOCK)
+        close(conn);
+      return;
+    }
+  }
+}
+
+// Same grammar as the standard input protocol: a key count followed by
+//  that many keys, 0 to request suggestions, or a negative number to end.
+void SwipeServer::process(const connection_ptr& conn) {
+  std::string& in = conn->input;
+  std::size_t pos = 0;
+
+  while(!conn->busy && !conn->closed) {
+    while(pos < in.size() && std::isspace((unsigned char) in[pos]))
+      pos++;
+    if(pos == in.size())
+      break;
+
+    if(conn->pending_keys > 0) {
+      conn->keys.insert(in[pos++]);
+      if(--conn->pending_keys == 0)
+        conn->session.advance(conn->keys);
+      continue;
+    }
+
+    std::size_t end = pos;
+    if(in[end] == '-' || in[end] == '+')
+      end++;
+    while(end < in.size() && std::isdigit((unsigned char) in[end]))
+      end++;
+    if(end == in.size() && !conn->eof)
+      break; // number may continue in the next read
+    if(end == pos || !std::isdigit((unsigned char) in[end - 1])) {
+      close(conn); // not a number: protocol error
+      return;
+    }
+
+    long code = std::strtol(in.c_str() + pos, nullptr, 10);
+    pos = end;
+    if(code < 0) {
+      conn->closing = true;
+      pos = in.size(); // nothing after the end of the session is answered
+    } else if(code == 0) {
+      dispatch(conn);
+    } else {
+      conn->keys.clear();
+      conn->pending_keys = code;
+    }
+  }
+  in.erase(0, pos);
+}
+
+void SwipeServer::dispatch(const connection_ptr& conn) {
+  conn->busy = true;
+  pool_->submit([this, conn]() {
+    Swipe::Suggestions suggestions = conn->session.get(num_suggestions_);
+    std::string reply;
+    for(std::string_view s : suggestions) {
+      reply += s;
+      reply += '\n';
+    }
+    // Assure that `num_suggestions_` messages are always sent
+    for(std::size_t i = suggestions.size(); i < num_suggestions_; i++)
+      reply += '\n';
+
+    {
+      std::lock_guard<std::mutex> lock(results_mutex_);
+      results_.emplace_back(conn, std::move(reply));
+    }
+    notify();
+  });
+}
+
+void SwipeServer::collect_results() {
+  std::uint64_t count;
+  while(read(event_fd_, &count, sizeof(count)) > 0);
+
+  std::vector<std::pair<connection_ptr, std::string>> results;
+  {
+    std::lock_guard<std::mutex> lock(results_mutex_);
+    results.swap(results_);
+  }
+
+  for(auto& result : results) {
+    const connection_ptr& conn = result.first;
+    if(conn->closed)
+      continue;
+    conn->output += result.second;
+    conn->session.reset();
+    conn->busy = false;
+    process(conn); // input buffered while ranking
+    flush(conn);
+  }
+}
+
+void SwipeServer::flush(const connection_ptr& conn) {
+  std::string& out = conn->output;
+  std::size_t sent = 0;
+  while(!conn->closed && sent < out.size()) {
+    ssize_t n = send(conn->fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+    if(n >= 0) {
+      sent += n;
+    } else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    } else if(errno != EINTR) {
+      close(conn);
+      return;
+    }
+  }
+  if(conn->closed)
+    return;
+  out.erase(0, sent);
+
+  if(out.empty() && conn->closing && !conn->busy) {
+    close(conn);
+    return;
+  }
+  std::uint32_t events = 0;
+  if(!conn->eof)
+    events |= EPOLLIN;
+  if(!out.empty())
+    events |= EPOLLOUT;
+  if(events != conn->events) {
+    epoll_set(epoll_fd_, EPOLL_CTL_MOD, conn->fd, events);
+    conn->events = events;
+  }
+}
+
+void SwipeServer::close(const connection_ptr& conn) {
+  if(conn->closed)
+    return;
+  conn->closed = true;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+  ::close(conn->fd);
+  connections_.erase(conn->fd);
+}
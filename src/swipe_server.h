@@ -0,0 +1,69 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_SWIPE_SERVER_H
+#define KEYBOARD_SWIPING_SWIPE_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "src/swipe_prediction.h"
+#include "src/thread_pool.h"
+
+// Serves the swipe protocol (see src/swipe.cpp) on a Unix domain socket.
+//  Every client gets its own Swipe::Session over the shared dictionary.
+//  Connections are multiplexed by a single epoll loop, which also applies
+//  key sets; `get` requests are ranked on a pool of worker threads.
+//
+// Note: Linux only (epoll, eventfd). Constructor and `run` throw
+//  std::system_error on socket failures.
+class SwipeServer {
+public:
+  SwipeServer(const Swipe& swipe,
+        const std::string& socket_path,
+        std::size_t num_workers,
+        std::size_t num_suggestions);
+  SwipeServer(const SwipeServer&) = delete;
+  SwipeServer& operator=(const SwipeServer&) = delete;
+  ~SwipeServer();
+
+  const std::string& path() const { return path_; }
+
+  // Blocks until `stop` is called
+  void run();
+  // Safe to call from other threads and from signal handlers
+  void stop();
+
+private:
+  struct Connection;
+  typedef std::shared_ptr<Connection> connection_ptr;
+
+  void notify();
+  void accept_clients();
+  void read_from(const connection_ptr& conn);
+  void process(const connection_ptr& conn);
+  void dispatch(const connection_ptr& conn);
+  void collect_results();
+  void flush(const connection_ptr& conn);
+  void close(const connection_ptr& conn);
+
+  const Swipe& swipe_;
+  std::string path_;
+  std::size_t num_suggestions_;
+  int listen_fd_;
+  int epoll_fd_;
+  int event_fd_;
+  std::atomic<bool> stopping_;
+  std::unordered_map<int, connection_ptr> connections_;
+
+  std::mutex results_mutex_;
+  std::vector<std::pair<connection_ptr, std::string>> results_;
+  std::unique_ptr<ThreadPool> pool_;
+};
+
+#endif /* end of include guard: KEYBOARD_SWIPING_SWIPE_SERVER_H */
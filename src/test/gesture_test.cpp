@@ -0,0 +1,62 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/gesture.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using gesture::Keyboard;
+
+TEST(GestureKeyboardTest, CenterHitsOnlyThatKey) {
+  Keyboard keyboard;
+  for(char c = 'a'; c <= 'z'; c++)
+    EXPECT_EQ(keyboard.keys_at(keyboard.center(c)), std::set<char>({ c }));
+  EXPECT_THROW(keyboard.center('1'), std::invalid_argument);
+}
+
+TEST(GestureKeyboardTest, GapTouchesNeighbours) {
+  Keyboard keyboard;
+  gesture::Point q = keyboard.center('q'), w = keyboard.center('w');
+  EXPECT_EQ(keyboard.keys_at({ (q.x + w.x) / 2, q.y }), std::set<char>({ 'q', 'w' }));
+  EXPECT_TRUE(keyboard.keys_at({ -100.0, -100.0 }).empty());
+}
+
+TEST(GestureSwipeTest, StartsAndEndsOnWordLetters) {
+  Keyboard keyboard;
+  std::mt19937 rng(1);
+  std::vector<std::set<char>> keys = gesture::swipe(keyboard, "Hello", rng);
+  ASSERT_FALSE(keys.empty());
+  EXPECT_EQ(keys.front(), std::set<char>({ 'h' }));
+  EXPECT_EQ(keys.back(), std::set<char>({ 'o' }));
+  for(std::size_t i = 1; i < keys.size(); i++)
+    EXPECT_NE(keys[i - 1], keys[i]);
+
+  // Every letter is touched in order
+  std::string word = "helo";
+  std::size_t next = 0;
+  for(const std::set<char>& letters : keys)
+    if(next < word.size() && letters.count(word[next]))
+      next++;
+  EXPECT_EQ(next, word.size());
+}
+
+TEST(GestureSwipeTest, SameSeedSameGesture) {
+  Keyboard keyboard;
+  std::mt19937 first(7), second(7), other(8);
+  auto a = gesture::swipe(keyboard, "keyboard", first, 12.0);
+  auto b = gesture::swipe(keyboard, "keyboard", second, 12.0);
+  auto c = gesture::swipe(keyboard, "keyboard", other, 12.0);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+}
+
+TEST(GestureSwipeTest, Message) {
+  std::vector<std::set<char>> keys = { { 'a' }, { 'a', 's' }, { 's' } };
+  EXPECT_EQ(gesture::to_message(keys), "1\na\n2\na\ns\n1\ns\n0\n");
+  EXPECT_EQ(gesture::to_message({}), "0\n");
+}
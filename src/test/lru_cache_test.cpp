@@ -0,0 +1,58 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/lru_cache.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+TEST(LRUCacheTest, DisabledWithZeroCapacity) {
+  LRUCache<std::string, int> cache;
+  cache.insert("a", 1);
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(cache.find("a"), nullptr);
+  EXPECT_EQ(cache.stats().lookups(), 0);
+}
+
+TEST(LRUCacheTest, FindInserted) {
+  LRUCache<std::string, int> cache(2);
+  cache.insert("a", 1);
+  const int* value = cache.find("a");
+  ASSERT_NE(value, nullptr);
+  EXPECT_EQ(*value, 1);
+  EXPECT_EQ(cache.find("b"), nullptr);
+  EXPECT_EQ(cache.stats().hits, 1);
+  EXPECT_EQ(cache.stats().misses, 1);
+  EXPECT_DOUBLE_EQ(cache.stats().hit_rate(), 0.5);
+}
+
+TEST(LRUCacheTest, EvictsLeastRecentlyUsed) {
+  LRUCache<std::string, int> cache(2);
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+  ASSERT_NE(cache.find("a"), nullptr); // "b" is now the oldest entry
+  cache.insert("c", 3);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.find("a"), nullptr);
+  EXPECT_EQ(cache.find("b"), nullptr);
+  EXPECT_NE(cache.find("c"), nullptr);
+}
+
+TEST(LRUCacheTest, InsertReplacesValue) {
+  LRUCache<std::string, int> cache(2);
+  cache.insert("a", 1);
+  cache.insert("a", 5);
+  EXPECT_EQ(cache.size(), 1);
+  ASSERT_NE(cache.find("a"), nullptr);
+  EXPECT_EQ(*cache.find("a"), 5);
+}
+
+TEST(LRUCacheTest, ShrinkCapacity) {
+  LRUCache<std::string, int> cache(3);
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+  cache.insert("c", 3);
+  cache.set_capacity(1);
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_NE(cache.find("c"), nullptr);
+}
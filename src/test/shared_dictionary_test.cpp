@@ -0,0 +1,110 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/shared_dictionary.h"
+#include "src/swipe_prediction.h"
+#include "src/utils.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const FrequencyMap frequencies = {
+  {"a",      10 },
+  {"i",      20 },
+  {"in",     30 },
+  {"inn",     5 },
+  {"an",     40 },
+  {"ant",    15 },
+  {"any",    25 },
+  {"nose",    7 },
+  {"no",     50 }
+};
+
+} /* anonymous */
+
+class SharedDictionaryTest : public testing::Test {
+protected:
+  void SetUp() override {
+    name = "/swipe-test-" + std::to_string(getpid());
+    for(const auto& entry : frequencies)
+      trie.insert(entry.first);
+  }
+
+  void TearDown() override {
+    if(SharedDictionary::exists(name))
+      SharedDictionary::remove(name);
+  }
+
+  std::string name;
+  Trie trie;
+};
+
+TEST_F(SharedDictionaryTest, CreateAndAttach) {
+  SharedDictionary created = SharedDictionary::create(name, trie, frequencies);
+  EXPECT_TRUE(SharedDictionary::exists(name));
+  SharedDictionary attached = SharedDictionary::attach(name);
+  EXPECT_EQ(attached.size(), trie.size());
+  EXPECT_EQ(attached.bytes(), created.bytes());
+
+  for(const auto& entry : frequencies)
+    EXPECT_TRUE(attached.contains(entry.first)) << entry.first;
+  for(const char* s : { "dog", "nos", "ants", "" })
+    EXPECT_FALSE(attached.contains(s)) << s;
+}
+
+TEST_F(SharedDictionaryTest, MirrorsTrieStructure) {
+  SharedDictionary dict = SharedDictionary::create(name, trie, frequencies);
+  const SharedDictionary::Node* no = dict.find("no");
+  ASSERT_NE(no, nullptr);
+  EXPECT_TRUE(no->has_children());
+  EXPECT_EQ(dict.find("in"), dict.find("inn")); // repeated letters collapse
+  EXPECT_EQ(dict.root()->get_child('N'), dict.root()->get_child('n'));
+
+  const SharedDictionary::Node* any = dict.find("any");
+  ASSERT_NE(any, nullptr);
+  ASSERT_EQ(any->words_end() - any->words_begin(), 1);
+  EXPECT_EQ(any->words_begin()->str(), "any");
+  EXPECT_EQ(any->words_begin()->rank(), utils::frequency_rank(25));
+}
+
+TEST_F(SharedDictionaryTest, OpenBuildsOnce) {
+  int builds = 0;
+  auto build = [&builds](Trie& t, FrequencyMap& f) {
+    builds++;
+    t.insert("pizza");
+    f["pizza"] = 1;
+  };
+  SharedDictionary first = SharedDictionary::open(name, build);
+  SharedDictionary second = SharedDictionary::open(name, build);
+  EXPECT_EQ(builds, 1);
+  EXPECT_TRUE(second.contains("pizza"));
+}
+
+TEST_F(SharedDictionaryTest, SwipeMatchesTrie) {
+  Swipe local(trie, frequencies);
+  Swipe shared(SharedDictionary::create(name, trie, frequencies));
+  EXPECT_TRUE(shared.contains("nose"));
+  EXPECT_THROW(shared.insert("dog", 1), std::logic_error);
+
+  for(const std::string gesture : { "ANT", "NOSE", "IN", "ANY" }) {
+    for(char c : gesture) {
+      local.advance({ c });
+      shared.advance({ c });
+    }
+    EXPECT_EQ(shared.get(), local.get()) << gesture;
+    local.reset();
+    shared.reset();
+  }
+}
+
+TEST_F(SharedDictionaryTest, CompletionsMatchTrie) {
+  Swipe local(trie, frequencies);
+  Swipe shared(SharedDictionary::create(name, trie, frequencies));
+  for(const char* prefix : { "", "a", "an", "i", "inn", "INN", "No", "x" })
+    EXPECT_EQ(shared.complete(prefix, 3), local.complete(prefix, 3)) << prefix;
+  EXPECT_EQ(shared.complete("n", 9), Swipe::Suggestions({ "no", "nose" }));
+}
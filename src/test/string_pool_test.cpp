@@ -0,0 +1,42 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/string_pool.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(StringPoolTest, AddCopies) {
+  StringPool pool;
+  std::string word = "pizza";
+  std::string_view pooled = pool.add(word);
+  word[0] = 'P';
+  EXPECT_EQ(pooled, "pizza");
+  EXPECT_NE(pooled.data(), word.data());
+  EXPECT_EQ(pool.size(), 5);
+  EXPECT_TRUE(pool.add("").empty());
+}
+
+TEST(StringPoolTest, ViewsSurviveGrowth) {
+  StringPool pool(16);
+  std::vector<std::string_view> views;
+  for(int i = 0; i < 100; i++)
+    views.push_back(pool.add("word" + std::to_string(i)));
+  for(int i = 0; i < 100; i++)
+    EXPECT_EQ(views[i], "word" + std::to_string(i));
+  EXPECT_GE(pool.capacity(), pool.size());
+
+  // Strings longer than a chunk get a chunk of their own
+  std::string longer(100, 'x');
+  EXPECT_EQ(pool.add(longer), longer);
+}
+
+TEST(StringPoolTest, ReserveKeepsStringsContiguous) {
+  StringPool pool(4);
+  pool.reserve(9);
+  std::string_view a = pool.add("ant"), b = pool.add("bee"), c = pool.add("cat");
+  EXPECT_EQ(a.data() + 3, b.data());
+  EXPECT_EQ(b.data() + 3, c.data());
+}
@@ -2,8 +2,16 @@
 // University of Florida
 
 #include "src/swipe_prediction.h"
+#include "src/utils.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,8 +27,8 @@ testing::AssertionResult contains(const Swipe& obj, const std::string& w) {
     return testing::AssertionFailure() << "Swipe doesn't contain word '" << w << '\'';
 }
 
-template <typename T>
-testing::AssertionResult contains(const std::vector<T>& vect, const T& q) {
+template <typename T, typename Q>
+testing::AssertionResult contains(const std::vector<T>& vect, const Q& q) {
   bool found = false;
   for(auto iter = vect.cbegin(); iter != vect.cend(); ++iter)
     if(*iter == q) {
@@ -107,3 +115,244 @@ TEST_P(SwipePredictionTest, SuggestionsContains) {
 }
 
 INSTANTIATE_TEST_SUITE_P(PredictionMatch, SwipePredictionTest, testing::ValuesIn(params));
+
+TEST(SwipeCacheTest, RepeatedGestureHitsCache) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  const input_type& input = params.front().first;
+
+  for(const std::set<char>& keys : input)
+    local.advance(keys);
+  Swipe::Suggestions first = local.get(4);
+  local.reset();
+
+  for(const std::set<char>& keys : input)
+    local.advance(keys);
+  EXPECT_EQ(local.get(4), first);
+  EXPECT_EQ(local.cache_stats().hits, 1);
+  EXPECT_EQ(local.cache_stats().misses, 1);
+}
+
+TEST(SwipeCacheTest, InsertInvalidatesCache) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  const input_type input = { { 'T' }, { 'E' }, { 'S' }, { 'T' } };
+
+  for(const std::set<char>& keys : input)
+    local.advance(keys);
+  EXPECT_FALSE(contains(local.get(), std::string("tet")));
+
+  local.insert("tet", 1);
+  for(const std::set<char>& keys : input)
+    local.advance(keys);
+  EXPECT_TRUE(contains(local.get(), std::string("tet")));
+  EXPECT_EQ(local.cache_stats().hits, 0);
+}
+
+TEST(SwipeLoadTest, ReloadReplacesDictionary) {
+  const std::string filename = testing::TempDir() + "swipe_load_test.csv";
+  {
+    std::ofstream os(filename);
+    os << "word,count\ntest,350\ntet,10\n";
+  }
+  Swipe local(filename);
+  local.insert("tent", 5000);
+  local.load(filename);
+  EXPECT_FALSE(contains(local, "tent"));
+  for(char c : std::string("TEST"))
+    local.advance({ c });
+  EXPECT_EQ(local.get(), Swipe::Suggestions({ "test", "tet" }));
+  std::remove(filename.c_str());
+}
+
+TEST(SwipeRankTest, FrequencyOrdersSimilarLengths) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  for(char c : std::string("FIEND"))
+    local.advance({ c });
+  const Swipe::Suggestions expected = { "find", "fiend" };
+  EXPECT_EQ(local.get(2), expected);
+}
+
+TEST(SwipeRankTest, MuchLongerWordsRankFirst) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  local.insert("fd", 100000);
+  for(char c : std::string("FIEND"))
+    local.advance({ c });
+  Swipe::Suggestions suggestions = local.get();
+  ASSERT_EQ(suggestions.size(), 3);
+  EXPECT_EQ(suggestions.back(), "fd");
+}
+
+TEST(SwipeRankTest, InsertAddsToKnownFrequency) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  local.insert("fiend", 480); // 42 + 480 overtakes "find" (512)
+  for(char c : std::string("FIEND"))
+    local.advance({ c });
+  EXPECT_EQ(local.get(1), Swipe::Suggestions({ "fiend" }));
+}
+
+TEST(SwipeRankTest, QuantisedRanksKeepOrder) {
+  for(std::uint64_t count : { 0ull, 1ull, 2ull, 42ull, 512ull, 23135851162ull }) {
+    EXPECT_LE(utils::frequency_rank(count), utils::frequency_rank(count + count / 100 + 1));
+    std::uint64_t back = utils::rank_frequency(utils::frequency_rank(count));
+    EXPECT_NEAR((double) back, (double) count, count * 0.001 + 0.5);
+  }
+  EXPECT_EQ(utils::frequency_rank(0), 0);
+  EXPECT_EQ(utils::frequency_rank(~0ull), 0xFFFF);
+}
+
+TEST(SwipeRankTest, SuggestionsOutliveInserts) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  for(char c : std::string("FIEND"))
+    local.advance({ c });
+  Swipe::Suggestions suggestions = local.get();
+  for(int i = 0; i < 1000; i++)
+    local.insert("fd" + std::string(i % 7, 'e'), 1);
+  EXPECT_EQ(suggestions, Swipe::Suggestions({ "find", "fiend" }));
+}
+
+TEST(SwipeParallelTest, MatchesSerialExpansion) {
+  Swipe serial(init_list.cbegin(), init_list.cend());
+  Swipe parallel(init_list.cbegin(), init_list.cend());
+  parallel.set_parallel_expansion(3, 1); // every frontier goes parallel
+  serial.set_cache_capacity(0);
+  parallel.set_cache_capacity(0);
+
+  for(const test_param_type& param : params) {
+    serial.reset();
+    parallel.reset();
+    for(const std::set<char>& keys : param.first) {
+      serial.advance(keys);
+      parallel.advance(keys);
+    }
+    EXPECT_EQ(parallel.get(), serial.get());
+  }
+}
+
+TEST(SwipeCompleteTest, MostFrequentFirst) {
+  EXPECT_EQ(swipe.complete("p", 5), Swipe::Suggestions({ "pizza", "pasta", "page" }));
+  EXPECT_EQ(swipe.complete("P", 2), Swipe::Suggestions({ "pizza", "pasta" }));
+  EXPECT_EQ(swipe.complete("fi", 5), Swipe::Suggestions({ "find", "fiend" }));
+  EXPECT_EQ(swipe.complete("teach", 5), Swipe::Suggestions({ "teach" }));
+  EXPECT_EQ(swipe.complete("", 2), Swipe::Suggestions({ "pizza", "pasta" }));
+  EXPECT_TRUE(swipe.complete("x", 5).empty());
+  EXPECT_TRUE(swipe.complete("teachers", 5).empty());
+  EXPECT_TRUE(swipe.complete("p", 0).empty());
+}
+
+TEST(SwipeCompleteTest, RepeatedLettersArePrefixes) {
+  const source_type words = {
+    { "hello", 10 }, { "help", 30 }, { "helo", 20 }, { "hell", 5 }, { "hhelp", 50 }
+  };
+  Swipe local(words.cbegin(), words.cend());
+  // All of them share the collapsed key "hel"
+  EXPECT_EQ(local.complete("hel", 9), Swipe::Suggestions({ "help", "helo", "hello", "hell" }));
+  EXPECT_EQ(local.complete("hell", 9), Swipe::Suggestions({ "hello", "hell" }));
+  EXPECT_EQ(local.complete("hh", 9), Swipe::Suggestions({ "hhelp" }));
+
+  // Only "hello" lies below "helo", where "l" is doubled
+  const source_type others = { { "hello", 10 }, { "helps", 30 } };
+  Swipe other(others.cbegin(), others.cend());
+  EXPECT_EQ(other.complete("hel", 9), Swipe::Suggestions({ "helps", "hello" }));
+  EXPECT_EQ(other.complete("hell", 9), Swipe::Suggestions({ "hello" }));
+  EXPECT_TRUE(other.complete("helll", 9).empty());
+}
+
+TEST(SwipeCompleteTest, UpperCasePrefix) {
+  const source_type words = { { "hello", 10 }, { "help", 30 }, { "ball", 5 }, { "eel", 7 } };
+  Swipe local(words.cbegin(), words.cend());
+  EXPECT_EQ(local.complete("HELL", 3), Swipe::Suggestions({ "hello" }));
+  EXPECT_EQ(local.complete("Hell", 3), local.complete("hell", 3));
+  EXPECT_EQ(local.complete("BALL", 3), Swipe::Suggestions({ "ball" }));
+  EXPECT_EQ(local.complete("EE", 3), Swipe::Suggestions({ "eel" }));
+  EXPECT_EQ(local.complete("eE", 3), Swipe::Suggestions({ "eel" }));
+}
+
+TEST(SwipeCompleteTest, EqualRanksAllFound) {
+  const source_type words = { { "tab", 7 }, { "tar", 7 }, { "tan", 7 }, { "to", 7 }, { "ten", 1 } };
+  Swipe local(words.cbegin(), words.cend());
+  Swipe::Suggestions found = local.complete("t", 3);
+  EXPECT_EQ(found.size(), 3);
+  EXPECT_FALSE(contains(found, "ten"));
+  found = local.complete("t", 9);
+  ASSERT_EQ(found.size(), 5);
+  EXPECT_EQ(found.back(), "ten");
+  std::sort(found.begin(), found.end() - 1);
+  EXPECT_EQ(found, Swipe::Suggestions({ "tab", "tan", "tar", "to", "ten" }));
+}
+
+TEST(SwipeCompleteTest, MatchesExhaustiveSearch) {
+  // Two letters give plenty of repeated runs
+  std::map<std::string, std::size_t> words;
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> length(1, 7), letter(0, 1), count(1, 1000);
+  for(int i = 0; i < 400; i++) {
+    std::string word;
+    for(int n = length(rng); n > 0; n--)
+      word += "ab"[letter(rng)];
+    words[word] = count(rng);
+  }
+  Swipe local(words.cbegin(), words.cend());
+
+  for(const char* prefix : { "", "a", "aa", "ab", "abb", "bba", "aab", "abab", "bbb" }) {
+    std::vector<std::pair<std::uint16_t, std::string>> expected;
+    for(const auto& word : words)
+      if(word.first.compare(0, std::strlen(prefix), prefix) == 0)
+        expected.emplace_back(utils::frequency_rank(word.second), word.first);
+    std::sort(expected.begin(), expected.end());
+
+    Swipe::Suggestions found = local.complete(prefix, 5);
+    ASSERT_EQ(found.size(), std::min<std::size_t>(5, expected.size())) << prefix;
+    // Ties may come in any order, so compare ranks
+    for(std::size_t i = 0; i < found.size(); i++) {
+      auto match = std::find_if(expected.cbegin(), expected.cend(),
+            [&](const std::pair<std::uint16_t, std::string>& e) { return e.second == found[i]; });
+      ASSERT_NE(match, expected.cend()) << found[i];
+      EXPECT_EQ(match->first, expected[expected.size() - 1 - i].first) << prefix;
+    }
+  }
+}
+
+TEST(SwipeCompleteTest, FollowsInserts) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  Swipe snapshot(local);
+  local.insert("pizzeria", 10);
+  local.insert("page", 2000);
+  EXPECT_EQ(local.complete("p", 2), Swipe::Suggestions({ "page", "pizza" }));
+  EXPECT_EQ(local.complete("pizz", 3), Swipe::Suggestions({ "pizza", "pizzeria" }));
+  EXPECT_EQ(snapshot.complete("p", 2), Swipe::Suggestions({ "pizza", "pasta" }));
+}
+
+TEST(SwipeSnapshotTest, CustomisationStaysLocal) {
+  Swipe base(init_list.cbegin(), init_list.cend());
+  Swipe user(base);
+  user.insert("tet", 5000);
+  EXPECT_TRUE(contains(user, "tet"));
+  EXPECT_FALSE(contains(base, "tet"));
+
+  for(char c : std::string("TEST")) {
+    base.advance({ c });
+    user.advance({ c });
+  }
+  EXPECT_EQ(base.get(), Swipe::Suggestions({ "test" }));
+  EXPECT_EQ(user.get(1), Swipe::Suggestions({ "tet" }));
+}
+
+TEST(SwipeSnapshotTest, FrequencyUpdatesAreLocal) {
+  Swipe base(init_list.cbegin(), init_list.cend());
+  Swipe user(base);
+  user.insert("fiend", 1000); // now more frequent than "find" for this user
+
+  for(char c : std::string("FIEND")) {
+    base.advance({ c });
+    user.advance({ c });
+  }
+  EXPECT_EQ(base.get(1), Swipe::Suggestions({ "find" }));
+  EXPECT_EQ(user.get(1), Swipe::Suggestions({ "fiend" }));
+}
+
+TEST(SwipeSnapshotTest, InsertKnownWordKeepsItUnique) {
+  Swipe local(init_list.cbegin(), init_list.cend());
+  EXPECT_EQ(local.insert("fiend", 1000).size(), 1);
+  for(char c : std::string("FIEND"))
+    local.advance({ c });
+  EXPECT_EQ(local.get(), Swipe::Suggestions({ "fiend", "find" }));
+}
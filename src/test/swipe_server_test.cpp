@@ -0,0 +1,153 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/swipe_server.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const std::vector<std::pair<std::string, std::size_t>> init_list = {
+  {"test",  350 },
+  {"tent",   42 },
+  {"map",   345 },
+  {"mop",    12 },
+  {"pizza", 982 }
+};
+const std::size_t num_suggestions = 4;
+
+class Client {
+public:
+  explicit Client(const std::string& path) {
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    connected_ = connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  }
+  ~Client() { ::close(fd_); }
+
+  bool connected() const { return connected_; }
+  void send(const std::string& msg) { ::send(fd_, msg.data(), msg.size(), MSG_NOSIGNAL); }
+  void shutdown_write() { ::shutdown(fd_, SHUT_WR); }
+
+  // Returns an empty string once the server closed the connection
+  std::string read_line() {
+    std::string line;
+    char c;
+    while(::read(fd_, &c, 1) == 1) {
+      line += c;
+      if(c == '\n')
+        break;
+    }
+    return line;
+  }
+
+  std::vector<std::string> read_suggestions() {
+    std::vector<std::string> lines;
+    for(std::size_t i = 0; i < num_suggestions; i++)
+      lines.push_back(read_line());
+    return lines;
+  }
+
+private:
+  int fd_;
+  bool connected_;
+};
+
+std::string gesture(const std::string& word) {
+  std::string msg;
+  for(char c : word)
+    msg += "1 " + std::string(1, c) + '\n';
+  return msg + "0\n";
+}
+
+} /* anonymous */
+
+class SwipeServerTest : public testing::Test {
+protected:
+  SwipeServerTest() : swipe(init_list.cbegin(), init_list.cend()) {}
+
+  void SetUp() override {
+    path = testing::TempDir() + "swipe_server_test.sock";
+    server.reset(new SwipeServer(swipe, path, 2, num_suggestions));
+    loop = std::thread([this]() { server->run(); });
+  }
+
+  void TearDown() override {
+    server->stop();
+    loop.join();
+    server.reset();
+  }
+
+  Swipe swipe;
+  std::string path;
+  std::unique_ptr<SwipeServer> server;
+  std::thread loop;
+};
+
+TEST_F(SwipeServerTest, AnswersGesture) {
+  Client client(path);
+  ASSERT_TRUE(client.connected());
+  EXPECT_EQ(client.read_line(), "READY\n");
+
+  client.send(gesture("test"));
+  std::vector<std::string> lines = client.read_suggestions();
+  EXPECT_EQ(lines.front(), "test\n");
+  for(std::size_t i = 1; i < lines.size(); i++)
+    EXPECT_EQ(lines[i].back(), '\n');
+}
+
+TEST_F(SwipeServerTest, IndependentSessions) {
+  Client first(path), second(path);
+  ASSERT_TRUE(first.connected());
+  ASSERT_TRUE(second.connected());
+  EXPECT_EQ(first.read_line(), "READY\n");
+  EXPECT_EQ(second.read_line(), "READY\n");
+
+  // Interleave both gestures so any state leaking between clients shows up
+  const std::string map = gesture("map"), test = gesture("test");
+  first.send(map.substr(0, 4));
+  second.send(test.substr(0, 4));
+  first.send(map.substr(4));
+  second.send(test.substr(4));
+  EXPECT_EQ(first.read_suggestions().front(), "map\n");
+  EXPECT_EQ(second.read_suggestions().front(), "test\n");
+
+  // Sessions are reset after each answer
+  first.send(gesture("pizza"));
+  EXPECT_EQ(first.read_suggestions().front(), "pizza\n");
+}
+
+TEST_F(SwipeServerTest, NegativeCodeClosesConnection) {
+  Client client(path);
+  ASSERT_TRUE(client.connected());
+  EXPECT_EQ(client.read_line(), "READY\n");
+  client.send("-1\n");
+  EXPECT_EQ(client.read_line(), "");
+}
+
+TEST_F(SwipeServerTest, AnswersBeforeHalfClose) {
+  Client client(path);
+  ASSERT_TRUE(client.connected());
+  EXPECT_EQ(client.read_line(), "READY\n");
+
+  // The gesture may still be buffered, or being ranked, at end of file
+  client.send(gesture("test"));
+  client.shutdown_write();
+  std::vector<std::string> lines = client.read_suggestions();
+  EXPECT_EQ(lines.front(), "test\n");
+  for(std::size_t i = 1; i < lines.size(); i++)
+    EXPECT_EQ(lines[i].back(), '\n');
+  EXPECT_EQ(client.read_line(), "");
+}
@@ -0,0 +1,60 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/thread_pool.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+    for(int i = 0; i < 100; i++)
+      pool.submit([&count]() { count++; });
+  } // destructor drains the queue
+  EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, AtLeastOneWorker) {
+  std::atomic<bool> ran(false);
+  {
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.size(), 1);
+    pool.submit([&ran]() { ran = true; });
+  }
+  EXPECT_TRUE(ran);
+}
+
+TEST(ThreadPoolTest, ParallelForRunsEveryChunkOnce) {
+  ThreadPool pool(3);
+  std::vector<std::atomic<int>> runs(1000);
+  std::vector<int> per_slot(pool.size() + 1, 0);
+  pool.parallel_for(runs.size(), [&](std::size_t chunk, std::size_t slot) {
+    runs[chunk]++;
+    per_slot.at(slot)++; // each slot belongs to a single thread
+  });
+  for(const std::atomic<int>& count : runs)
+    EXPECT_EQ(count, 1);
+  int total = 0;
+  for(int count : per_slot)
+    total += count;
+  EXPECT_EQ(total, 1000);
+}
+
+TEST(ThreadPoolTest, ParallelForOnBusyPool) {
+  ThreadPool pool(1);
+  std::atomic<bool> release(false);
+  pool.submit([&release]() { while(!release) std::this_thread::yield(); });
+  int sum = 0;
+  // The only worker is busy, so the caller runs every chunk itself
+  pool.parallel_for(10, [&sum](std::size_t chunk, std::size_t slot) {
+    EXPECT_EQ(slot, 0);
+    sum += chunk;
+  });
+  EXPECT_EQ(sum, 45);
+  release = true;
+}
@@ -4,7 +4,11 @@
 #include "src/trie.h"
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 testing::AssertionResult contains(const Trie& t, const std::string& s) {
@@ -161,3 +165,264 @@ TEST_F(TrieSmallTest, RemoveNonElement) {
     EXPECT_EQ(trie.size(), size);
   }
 }
+
+TEST_F(TrieSmallTest, RemoveOtherSpellingOfKey) {
+  Trie::size_type size = trie.size();
+  EXPECT_EQ(trie.erase("nno"), trie.end()); // same key as "no"
+  EXPECT_EQ(trie.size(), size);
+  EXPECT_TRUE(contains(trie, "no"));
+}
+
+TEST_F(TrieSmallTest, RemoveAll) {
+  const std::vector<std::string> targets
+      = { "nose", "ant", "dog", "a", "inn", "nos", "any" };
+  Trie::size_type size = trie.size();
+  EXPECT_EQ(trie.erase_all(targets), 5);
+  EXPECT_EQ(trie.size(), size - 5);
+  for(const char* s : { "nose", "ant", "a", "inn", "any" })
+    EXPECT_FALSE(contains(trie, s));
+  for(const char* s : { "I", "in", "an", "no" })
+    EXPECT_TRUE(contains(trie, s));
+  // Pruned branches are gone, shared prefixes stay
+  EXPECT_EQ(trie.find("nos"), trie.end());
+  EXPECT_EQ(trie.find("ant"), trie.end());
+  EXPECT_NE(trie.find("an"), trie.end());
+}
+
+TEST_F(TrieSmallTest, RemoveAllEmptiesTrie) {
+  EXPECT_EQ(trie.erase_all(init_list), init_list.size());
+  EXPECT_TRUE(trie.empty());
+  EXPECT_FALSE(trie.cbegin()->has_children());
+}
+
+TEST_F(TrieSmallTest, RemoveAllKeepsCopy) {
+  Trie copy(trie);
+  trie.erase_all({ "nose", "no", "inn" });
+  for(const std::string& s : init_list)
+    EXPECT_TRUE(contains(copy, s));
+  EXPECT_FALSE(contains(trie, "nose"));
+}
+
+TEST_F(TrieSmallTest, RemoveFromFile) {
+  const std::string filename = testing::TempDir() + "trie_blocklist.txt";
+  {
+    std::ofstream os(filename);
+    os << "nose\nant dog\n\nany\n";
+  }
+  Trie::size_type size = trie.size();
+  EXPECT_EQ(erase_from_file(trie, filename), 3);
+  EXPECT_EQ(trie.size(), size - 3);
+  for(const char* s : { "nose", "ant", "any" })
+    EXPECT_FALSE(contains(trie, s));
+  EXPECT_TRUE(contains(trie, "no"));
+  EXPECT_TRUE(contains(trie, "an"));
+  // Branches left without words are pruned
+  EXPECT_EQ(trie.find("nos"), trie.end());
+  EXPECT_EQ(trie.find("ant"), trie.end());
+  std::remove(filename.c_str());
+}
+
+TEST_F(TrieSmallTest, DepthFirstVisitsEveryWord) {
+  std::size_t words = 0;
+  for(auto it = trie.dfs_begin(); it != trie.dfs_end(); ++it)
+    words += it->get_words().size();
+  EXPECT_EQ(words, trie.size());
+}
+
+TEST_F(TrieSmallTest, DepthFirstPreOrder) {
+  const Trie& const_trie = trie;
+  std::vector<const Trie::Node*> expected = {
+    const_trie.cbegin().operator->(),
+    const_trie.find("a").operator->(),
+    const_trie.find("an").operator->(),
+    const_trie.find("ant").operator->(),
+    const_trie.find("any").operator->(),
+    const_trie.find("i").operator->(),
+    const_trie.find("in").operator->(),
+    const_trie.find("n").operator->(),
+    const_trie.find("no").operator->(),
+    const_trie.find("nos").operator->(),
+    const_trie.find("nose").operator->()
+  };
+  std::vector<const Trie::Node*> visited;
+  for(auto it = trie.dfs_begin(); it != trie.dfs_end(); it++)
+    visited.push_back(&*it);
+  EXPECT_EQ(visited, expected);
+}
+
+TEST_F(TrieSmallTest, BreadthFirstByDepth) {
+  const Trie& const_trie = trie;
+  std::vector<const Trie::Node*> visited;
+  for(auto it = trie.bfs_begin(); it != trie.bfs_end(); ++it)
+    visited.push_back(&*it);
+  ASSERT_EQ(visited.size(), 11);
+  EXPECT_EQ(visited[0], const_trie.cbegin().operator->());
+  EXPECT_EQ(visited[1], const_trie.find("a").operator->());
+  EXPECT_EQ(visited[3], const_trie.find("n").operator->());
+  EXPECT_EQ(visited[4], const_trie.find("an").operator->());
+  EXPECT_EQ(visited.back(), const_trie.find("nose").operator->());
+}
+
+TEST_F(TrieSmallTest, CopyIsDeep) {
+  Trie copy(trie);
+  EXPECT_EQ(copy.size(), trie.size());
+  EXPECT_EQ(std::distance(copy.dfs_begin(), copy.dfs_end()),
+            std::distance(trie.dfs_begin(), trie.dfs_end()));
+  for(const std::string& s : init_list)
+    EXPECT_TRUE(contains(copy, s));
+  copy.erase("nose");
+  EXPECT_TRUE(contains(trie, "nose"));
+}
+
+TEST_F(TrieSmallTest, CopySharesNodes) {
+  const Trie copy(trie);
+  const Trie& const_trie = trie;
+  EXPECT_EQ(copy.cbegin(), const_trie.cbegin());
+  EXPECT_EQ(copy.find("nose"), const_trie.find("nose"));
+}
+
+TEST_F(TrieSmallTest, CopyOnWritePathOnly) {
+  Trie copy(trie);
+  const Trie& const_copy = copy;
+  const Trie& const_trie = trie;
+  ASSERT_NE(copy.insert("anew"), copy.end());
+
+  EXPECT_TRUE(contains(copy, "anew"));
+  EXPECT_FALSE(contains(trie, "anew"));
+  EXPECT_EQ(copy.size(), trie.size() + 1);
+  // Nodes on the path to the new word are copied, the rest stay shared
+  EXPECT_NE(const_copy.find("an"), const_trie.find("an"));
+  EXPECT_EQ(const_copy.find("ant"), const_trie.find("ant"));
+  EXPECT_EQ(const_copy.find("nose"), const_trie.find("nose"));
+}
+
+TEST_F(TrieSmallTest, EraseFromOriginalKeepsCopy) {
+  Trie copy(trie);
+  EXPECT_EQ(trie.erase("nose"), trie.end());
+  EXPECT_FALSE(contains(trie, "nose"));
+  EXPECT_TRUE(contains(copy, "nose"));
+  trie.clear();
+  for(const std::string& s : init_list)
+    EXPECT_TRUE(contains(copy, s));
+}
+
+TEST(TrieAssignTest, MatchesInsertion) {
+  const std::vector<std::string> words
+      = { "nose", "an", "Inn", "a", "any", "ant", "no", "in", "I", "aab", "ab" };
+  Trie inserted, assigned;
+  for(const std::string& s : words)
+    inserted.insert(s);
+  assigned.assign(words);
+
+  EXPECT_EQ(assigned.size(), inserted.size());
+  for(const std::string& s : words)
+    EXPECT_TRUE(contains(assigned, s));
+  EXPECT_FALSE(contains(assigned, "nos"));
+  EXPECT_EQ(assigned.find("aab"), assigned.find("ab"));
+
+  // Same shape: both traversals see the same keys and word counts
+  auto it = inserted.dfs_begin();
+  auto jt = assigned.dfs_begin();
+  for(; it != inserted.dfs_end() && jt != assigned.dfs_end(); ++it, ++jt) {
+    EXPECT_EQ(it->get_words().size(), jt->get_words().size());
+    EXPECT_EQ(it->has_children(), jt->has_children());
+  }
+  EXPECT_EQ(it, inserted.dfs_end());
+  EXPECT_EQ(jt, assigned.dfs_end());
+}
+
+TEST(TrieAssignTest, ReplacesContentsAndSkipsInvalid) {
+  Trie trie;
+  trie.insert("dog");
+  trie.assign({ "cat", "c4t", "" });
+  EXPECT_FALSE(contains(trie, "dog"));
+  EXPECT_TRUE(contains(trie, "cat"));
+  EXPECT_FALSE(contains(trie, "c4t"));
+  EXPECT_EQ(trie.size(), 2);
+}
+
+TEST(TrieAssignTest, RepeatedWordsOnce) {
+  Trie trie;
+  trie.assign({ "ant", "aant", "an", "ant", "aant" });
+  EXPECT_EQ(trie.size(), 3);
+  EXPECT_EQ(trie.find("ant")->get_words().size(), 2); // "ant" and "aant"
+}
+
+TEST_F(TrieSmallTest, RanksFollowWords) {
+  trie.rank_words([](std::string_view word, Trie::rank_type) {
+    return (Trie::rank_type) word.size();
+  });
+  Trie::iterator node = trie.find("an");
+  ASSERT_NE(node, trie.end());
+  EXPECT_EQ(node->get_rank("an"), 2);
+  EXPECT_EQ(node->get_ranks().size(), node->get_words().size());
+
+  Trie copy(trie);
+  EXPECT_TRUE(trie.find("in")->set_rank("inn", 9));
+  EXPECT_FALSE(trie.find("in")->set_rank("dog", 9));
+  EXPECT_EQ(trie.find("in")->get_rank("inn"), 9);
+  EXPECT_EQ(copy.find("in")->get_rank("inn"), 3);
+
+  trie.erase("in"); // ranks stay aligned with the remaining words
+  EXPECT_EQ(trie.find("inn")->get_rank("inn"), 9);
+  EXPECT_EQ(trie.find("inn")->get_ranks().size(), 1);
+}
+
+TEST(TrieAssignTest, WordsAreContiguous) {
+  Trie trie;
+  trie.assign({ "ant", "an", "any" });
+  std::vector<std::string_view> words;
+  for(auto it = trie.dfs_begin(); it != trie.dfs_end(); ++it)
+    words.insert(words.end(), it->get_words().cbegin(), it->get_words().cend());
+  ASSERT_EQ(words.size(), 3);
+  // Assigned in key order: "an", "ant", "any"
+  EXPECT_EQ(words[0].data() + words[0].size(), words[1].data());
+  EXPECT_EQ(words[1].data() + words[1].size(), words[2].data());
+}
+
+TEST_F(TrieSmallTest, CopyKeepsWordsAlive) {
+  Trie* original = new Trie(trie);
+  original->insert("nosey");
+  Trie copy(*original);
+  delete original;
+  EXPECT_TRUE(contains(copy, "nosey"));
+  EXPECT_EQ(copy.find("nosey")->get_words().back(), "nosey");
+}
+
+TEST_F(TrieSmallTest, BestRankFollowsChanges) {
+  trie.rank_words([](std::string_view word, Trie::rank_type) {
+    return (Trie::rank_type) word.size();
+  });
+  EXPECT_EQ(trie.cbegin()->best_rank(), 4); // "nose"
+  EXPECT_EQ(trie.find("a")->best_rank(), 3);
+  EXPECT_EQ(trie.find("any")->best_rank(), 3);
+
+  Trie copy(trie);
+  trie.find("any")->set_rank("any", 20);
+  EXPECT_EQ(trie.cbegin()->best_rank(), 20);
+  EXPECT_EQ(copy.cbegin()->best_rank(), 4);
+
+  trie.erase("any");
+  EXPECT_EQ(trie.find("a")->best_rank(), 3);
+  trie.insert("nosebleed");
+  trie.find("nosebleed")->set_rank("nosebleed", 9);
+  EXPECT_EQ(trie.find("no")->best_rank(), 9);
+  EXPECT_EQ(trie.cbegin()->best_rank(), 9);
+}
+
+TEST(TrieRunsTest, RepeatedLettersByPosition) {
+  Trie::Runs hello = Trie::runs_of("hello");
+  EXPECT_EQ(hello.doubled, 0x4);  // "ll"
+  EXPECT_EQ(hello.single, 0xB);   // h, e, o
+  Trie::Runs apple = Trie::runs_of("A-ppLe");
+  EXPECT_EQ(apple.doubled, 0x2);
+  EXPECT_EQ(apple.single, 0xD);
+  EXPECT_EQ(Trie::runs_of("").single, 0);
+
+  Trie trie;
+  trie.insert("hello");
+  trie.insert("helo");
+  Trie::Runs below = trie.find("he")->runs();
+  EXPECT_EQ(below.doubled, 0x4);
+  EXPECT_EQ(below.single, 0xF);
+}
@@ -0,0 +1,46 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/thread_pool.h"
+
+#include <utility>
+
+ThreadPool::ThreadPool(std::size_t num_threads) : stopping_(false) {
+  if(num_threads == 0)
+    num_threads = 1;
+  for(std::size_t i = 0; i < num_threads; i++)
+    workers_.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  available_.notify_all();
+  for(std::thread& worker : workers_)
+    worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::move(task));
+  }
+  available_.notify_one();
+}
+
+void ThreadPool::work() {
+  while(true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if(tasks_.empty())
+        return; // stopping and drained
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+    task();
+  }
+}
@@ -0,0 +1,88 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_THREAD_POOL_H
+#define KEYBOARD_SWIPING_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running tasks in submission order. Pending
+//  tasks are still run when the pool is destroyed.
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t num_threads);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  std::size_t size() const { return workers_.size(); }
+  void submit(std::function<void()> task);
+
+  // Calls `func(chunk, slot)` for every chunk in [0, num_chunks) and
+  //  returns once all of them ran. The calling thread works too, and
+  //  workers that become free claim the remaining chunks one at a time, so
+  //  a busy pool only delays the call. `slot` (less than size() + 1) is
+  //  unique to each participating thread, e.g. to give it its own output.
+  //  `func` must not throw.
+  template <class Func>
+  void parallel_for(std::size_t num_chunks, Func&& func);
+
+private:
+  struct ParallelState {
+    explicit ParallelState(std::size_t chunks) : num_chunks(chunks) {}
+
+    const std::size_t num_chunks;
+    std::atomic<std::size_t> next_chunk{0};
+    std::atomic<std::size_t> next_slot{1}; // slot 0 is the caller's
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t done = 0;
+  };
+
+  void work();
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable available_;
+  bool stopping_;
+};
+
+template <class Func>
+void ThreadPool::parallel_for(std::size_t num_chunks, Func&& func) {
+  if(num_chunks == 0)
+    return;
+  auto state = std::make_shared<ParallelState>(num_chunks);
+  // Workers starting after every chunk was claimed never touch `func`,
+  //  which may be gone by then
+  auto run = [state, &func](std::size_t slot) {
+    std::size_t ran = 0;
+    for(std::size_t chunk; (chunk = state->next_chunk++) < state->num_chunks; ran++)
+      func(chunk, slot);
+    if(ran > 0) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->done += ran;
+      if(state->done == state->num_chunks)
+        state->finished.notify_all();
+    }
+  };
+
+  std::size_t helpers = std::min(size(), num_chunks - 1);
+  for(std::size_t i = 0; i < helpers; i++)
+    submit([state, run]() { run(state->next_slot++); });
+  run(0);
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->finished.wait(lock, [&state]() { return state->done == state->num_chunks; });
+}
+
+#endif /* end of include guard: KEYBOARD_SWIPING_THREAD_POOL_H */
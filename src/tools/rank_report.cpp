@@ -0,0 +1,117 @@
+// Juliana Pacheco
+// University of Florida
+
+// Reports how ranking by quantised frequency (utils::frequency_rank)
+//  differs from ranking by the exact counts of a word,count CSV such as
+//  rcs/unigram_freq.csv. Quantisation is monotonic, so the only possible
+//  changes are words of different counts that end up with the same rank:
+//  their relative order is then decided by the tie-break instead.
+//
+// usage: rank_report WORDS_CSV [--show N]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include "src/tools/tool_utils.h"
+#include "src/utils.h"
+
+namespace {
+
+typedef tools::Counts::value_type Entry;
+
+// Pairs of words in `group` whose counts differ
+std::uint64_t differing_pairs(const std::vector<const Entry*>& group) {
+  std::map<std::uint64_t, std::uint64_t> same;
+  for(const Entry* entry : group)
+    same[entry->second]++;
+  std::uint64_t n = group.size(), pairs = n * (n - 1) / 2;
+  for(auto& count : same)
+    pairs -= count.second * (count.second - 1) / 2;
+  return pairs;
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  if(argc < 2) {
+    std::cerr << "usage: " << argv[0] << " WORDS_CSV [--show N]\n";
+    return -1;
+  }
+  std::size_t show = 10;
+  for(int i = 2; i + 1 < argc; i += 2)
+    if(std::string(argv[i]) == "--show")
+      show = std::strtoul(argv[i + 1], nullptr, 10);
+
+  try {
+    std::vector<Entry> entries = tools::read_counts(argv[1]);
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+      return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    // Words sharing a rank, most frequent ranks first
+    std::vector<std::vector<const Entry*>> groups;
+    std::uint32_t prev_rank = std::numeric_limits<std::uint32_t>::max();
+    std::size_t distinct_counts = 0;
+    std::uint64_t same_count_pairs = 0, run = 0;
+    for(std::size_t i = 0; i < entries.size(); i++) {
+      std::uint16_t rank = utils::frequency_rank(entries[i].second);
+      if(rank != prev_rank)
+        groups.emplace_back();
+      groups.back().push_back(&entries[i]);
+      prev_rank = rank;
+      if(i == 0 || entries[i].second != entries[i - 1].second) {
+        distinct_counts++;
+        run = 0;
+      }
+      same_count_pairs += run++;
+    }
+
+    std::uint64_t words_moved = 0, pairs_moved = 0;
+    std::vector<const std::vector<const Entry*>*> collapsed;
+    for(const auto& group : groups) {
+      std::uint64_t pairs = differing_pairs(group);
+      if(pairs == 0)
+        continue;
+      pairs_moved += pairs;
+      words_moved += group.size();
+      collapsed.push_back(&group);
+    }
+    const std::uint64_t n = entries.size();
+    const std::uint64_t pairs_total = (n > 0 ? n * (n - 1) / 2 : 0) - same_count_pairs;
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "words:            " << n << '\n'
+              << "distinct counts:  " << distinct_counts << '\n'
+              << "distinct ranks:   " << groups.size() << '\n'
+              << "bytes per count:  " << sizeof(std::size_t) << " -> "
+              << sizeof(std::uint16_t) << '\n'
+              << "words in ties:    " << words_moved << " ("
+              << (n ? 100.0 * words_moved / n : 0.0) << "%)\n"
+              << "pairs now tied:   " << pairs_moved << " of " << pairs_total
+              << " with different counts ("
+              << (pairs_total ? 100.0 * pairs_moved / pairs_total : 0.0) << "%)\n";
+
+    if(!collapsed.empty() && show > 0) {
+      std::cout << "most frequent ties:\n";
+      for(std::size_t i = 0; i < collapsed.size() && i < show; i++) {
+        const auto& group = *collapsed[i];
+        std::cout << "  rank " << utils::frequency_rank(group.front()->second) << ':';
+        for(std::size_t j = 0; j < group.size() && j < 4; j++)
+          std::cout << ' ' << group[j]->first << " (" << group[j]->second << ')';
+        if(group.size() > 4)
+          std::cout << " and " << group.size() - 4 << " more";
+        std::cout << '\n';
+      }
+    }
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
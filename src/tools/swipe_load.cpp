@@ -0,0 +1,350 @@
+// Juliana Pacheco
+// University of Florida
+
+// Load generator for the swipe protocol. Every client replays swipes of
+//  words drawn from WORDS (one word per line, anything after a comma is
+//  ignored), synthesised over the QWERTY geometry of src/keyboard.py, and
+//  the tool reports throughput and latency percentiles.
+//
+// Clients either connect to a `swipe --server` socket or each start their
+//  own `swipe` process and talk to it over stdin/stdout. Without --rate
+//  every client sends its next swipe as soon as the previous one was
+//  answered (closed loop). With --rate swipes are scheduled at fixed times
+//  and latency is measured from the scheduled time, so a slow server isn't
+//  hidden by clients that fall behind (open loop).
+//
+// The same --seed always replays the same swipes; --dump prints them as
+//  swipe protocol input instead, e.g. to feed `swipe` directly.
+//
+// usage: swipe_load WORDS [--socket PATH | --exec "COMMAND [ARGS]"]
+//          [--clients N] [--gestures N] [--rate GESTURES_PER_SECOND]
+//          [--jitter PIXELS] [--seed N] [--dump]
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "src/gesture.h"
+#include "src/tools/tool_utils.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Lines in every reply: the protocol always answers with `num_of_suggestions`
+//  (src/swipe.cpp) lines, padded with empty ones
+const std::size_t REPLY_LINES = 4;
+
+struct Options {
+  std::string words_file;
+  std::string socket_path;
+  std::string command = "./bazel-bin/swipe";
+  std::size_t clients = 1;
+  std::size_t gestures = 1000;
+  double rate = 0.0; // gestures per second over all clients; 0 is closed loop
+  double jitter = 8.0;
+  unsigned long seed = 42;
+  bool dump = false;
+};
+
+std::system_error errno_error(const std::string& what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+// One swipe session, over a socket or the pipes of a child process
+class Connection {
+public:
+  static std::unique_ptr<Connection> connect(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path))
+      throw std::invalid_argument("invalid socket path '" + path + '\'');
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+      throw errno_error("socket");
+    if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+      std::system_error error = errno_error("connect " + path);
+      ::close(fd);
+      throw error;
+    }
+    return std::unique_ptr<Connection>(new Connection(fd, fd, -1));
+  }
+
+  static std::unique_ptr<Connection> spawn(const std::string& command) {
+    std::istringstream split(command);
+    std::vector<std::string> args;
+    std::string arg;
+    while(split >> arg)
+      args.push_back(arg);
+    if(args.empty())
+      throw std::invalid_argument("empty command");
+    std::vector<char*> argv;
+    for(std::string& s : args)
+      argv.push_back(&s[0]);
+    argv.push_back(nullptr);
+
+    int to_child[2], from_child[2];
+    if(pipe2(to_child, O_CLOEXEC) < 0)
+      throw errno_error("pipe");
+    if(pipe2(from_child, O_CLOEXEC) < 0) {
+      std::system_error error = errno_error("pipe");
+      ::close(to_child[0]);
+      ::close(to_child[1]);
+      throw error;
+    }
+    pid_t pid = fork();
+    if(pid == 0) {
+      dup2(to_child[0], STDIN_FILENO);
+      dup2(from_child[1], STDOUT_FILENO);
+      execvp(argv[0], argv.data());
+      _exit(127);
+    }
+    ::close(to_child[0]);
+    ::close(from_child[1]);
+    if(pid < 0) {
+      std::system_error error = errno_error("fork");
+      ::close(to_child[1]);
+      ::close(from_child[0]);
+      throw error;
+    }
+    return std::unique_ptr<Connection>(new Connection(from_child[0], to_child[1], pid));
+  }
+
+  Connection(const Connection&) = delete;
+  Connection& operator=(const Connection&) = delete;
+
+  ~Connection() {
+    try {
+      send("-1\n");
+    } catch(const std::exception&) {
+      // the other end is already gone
+    }
+    ::close(out_fd_);
+    if(in_fd_ != out_fd_)
+      ::close(in_fd_);
+    if(pid_ > 0)
+      waitpid(pid_, nullptr, 0);
+  }
+
+  void send(const std::string& message) {
+    std::size_t sent = 0;
+    while(sent < message.size()) {
+      ssize_t n = write(out_fd_, message.data() + sent, message.size() - sent);
+      if(n < 0 && errno != EINTR)
+        throw errno_error("write");
+      if(n > 0)
+        sent += n;
+    }
+  }
+
+  std::string read_line() {
+    std::size_t end;
+    while((end = buffer_.find('\n')) == std::string::npos) {
+      char chunk[4096];
+      ssize_t n = read(in_fd_, chunk, sizeof(chunk));
+      if(n == 0)
+        throw std::runtime_error("connection closed");
+      if(n < 0 && errno != EINTR)
+        throw errno_error("read");
+      if(n > 0)
+        buffer_.append(chunk, n);
+    }
+    std::string line = buffer_.substr(0, end);
+    buffer_.erase(0, end + 1);
+    return line;
+  }
+
+private:
+  Connection(int in_fd, int out_fd, pid_t pid) : in_fd_(in_fd), out_fd_(out_fd), pid_(pid) {}
+
+  int in_fd_;
+  int out_fd_;
+  pid_t pid_;
+  std::string buffer_;
+};
+
+std::vector<std::string> read_words(const std::string& filename) {
+  std::ifstream is(filename);
+  if(!is)
+    throw std::runtime_error("can't read '" + filename + '\'');
+  std::vector<std::string> words;
+  std::string line;
+  while(std::getline(is, line)) {
+    std::string word = line.substr(0, line.find(','));
+    if(!word.empty() && std::all_of(word.cbegin(), word.cend(),
+          [](char c) { return std::isalpha((unsigned char) c); }))
+      words.push_back(word);
+  }
+  if(words.empty())
+    throw std::runtime_error("no words in '" + filename + '\'');
+  return words;
+}
+
+// Swipe messages of one client, fixed by the seed and the client index
+std::vector<std::string> script(const Options& options,
+      const std::vector<std::string>& words,
+      std::size_t client,
+      std::size_t num_gestures) {
+  const gesture::Keyboard keyboard;
+  std::mt19937 rng(options.seed + client);
+  std::uniform_int_distribution<std::size_t> pick(0, words.size() - 1);
+  std::vector<std::string> messages;
+  for(std::size_t i = 0; i < num_gestures; i++) {
+    const std::string& word = words[pick(rng)];
+    messages.push_back(gesture::to_message(gesture::swipe(keyboard, word, rng, options.jitter)));
+  }
+  return messages;
+}
+
+int usage(const char* name) {
+  std::cerr << "usage: " << name << " WORDS [--socket PATH | --exec \"COMMAND [ARGS]\"]\n"
+            << "         [--clients N] [--gestures N] [--rate GESTURES_PER_SECOND]\n"
+            << "         [--jitter PIXELS] [--seed N] [--dump]\n";
+  return -1;
+}
+
+bool parse(int argc, char* argv[], Options& options) {
+  for(int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if(arg == "--socket" && has_value)
+      options.socket_path = argv[++i];
+    else if(arg == "--exec" && has_value)
+      options.command = argv[++i];
+    else if(arg == "--clients" && has_value)
+      options.clients = std::strtoul(argv[++i], nullptr, 10);
+    else if(arg == "--gestures" && has_value)
+      options.gestures = std::strtoul(argv[++i], nullptr, 10);
+    else if(arg == "--rate" && has_value)
+      options.rate = std::strtod(argv[++i], nullptr);
+    else if(arg == "--jitter" && has_value)
+      options.jitter = std::strtod(argv[++i], nullptr);
+    else if(arg == "--seed" && has_value)
+      options.seed = std::strtoul(argv[++i], nullptr, 10);
+    else if(arg == "--dump")
+      options.dump = true;
+    else if(options.words_file.empty() && arg[0] != '-')
+      options.words_file = arg;
+    else
+      return false;
+  }
+  return !options.words_file.empty() && options.clients > 0 && options.rate >= 0.0;
+}
+
+} /* anonymous */
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if(!parse(argc, argv, options))
+    return usage(argv[0]);
+
+  try {
+    std::vector<std::string> words = read_words(options.words_file);
+    if(options.dump) {
+      for(const std::string& message : script(options, words, 0, options.gestures))
+        std::cout << message;
+      std::cout << "-1\n";
+      return 0;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    const std::size_t clients = options.clients;
+    std::vector<std::vector<std::string>> scripts;
+    std::vector<std::unique_ptr<Connection>> connections;
+    for(std::size_t c = 0; c < clients; c++) {
+      // Gestures are split evenly, the first clients taking the remainder
+      std::size_t share = options.gestures / clients + (c < options.gestures % clients);
+      scripts.push_back(script(options, words, c, share));
+      connections.push_back(options.socket_path.empty()
+            ? Connection::spawn(options.command)
+            : Connection::connect(options.socket_path));
+      connections.back()->read_line(); // READY
+    }
+
+    // Client c sends its i-th gesture at start + (i * clients + c) * interval
+    const std::chrono::duration<double> interval(options.rate > 0.0 ? 1.0 / options.rate : 0.0);
+    std::vector<std::vector<double>> latencies(clients);
+    std::atomic<std::size_t> failures(0);
+    std::mutex error_mutex;
+    std::string first_error;
+
+    const Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for(std::size_t c = 0; c < clients; c++) {
+      threads.emplace_back([&, c]() {
+        Connection& connection = *connections[c];
+        try {
+          for(std::size_t i = 0; i < scripts[c].size(); i++) {
+            Clock::time_point sent = Clock::now();
+            if(options.rate > 0.0) {
+              sent = start + std::chrono::duration_cast<Clock::duration>(
+                    interval * (double) (i * clients + c));
+              std::this_thread::sleep_until(sent);
+            }
+            connection.send(scripts[c][i]);
+            for(std::size_t line = 0; line < REPLY_LINES; line++)
+              connection.read_line();
+            latencies[c].push_back(
+                  std::chrono::duration<double, std::milli>(Clock::now() - sent).count());
+          }
+        } catch(const std::exception& e) {
+          failures++;
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if(first_error.empty())
+            first_error = e.what();
+        }
+      });
+    }
+    for(std::thread& thread : threads)
+      thread.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    connections.clear();
+
+    std::vector<double> all;
+    for(const std::vector<double>& client : latencies)
+      all.insert(all.end(), client.begin(), client.end());
+    std::sort(all.begin(), all.end());
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "clients:    " << clients << '\n'
+              << "gestures:   " << all.size() << " of " << options.gestures << '\n'
+              << "elapsed:    " << elapsed << " s\n"
+              << "throughput: " << (elapsed > 0.0 ? all.size() / elapsed : 0.0) << " gestures/s\n"
+              << "p50:        " << tools::percentile(all, 0.50) << " ms\n"
+              << "p99:        " << tools::percentile(all, 0.99) << " ms\n"
+              << "p999:       " << tools::percentile(all, 0.999) << " ms\n"
+              << "max:        " << (all.empty() ? 0.0 : all.back()) << " ms\n";
+    if(failures > 0) {
+      std::cerr << failures << " client(s) failed: " << first_error << '\n';
+      return -1;
+    }
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return -1;
+  }
+  return 0;
+}
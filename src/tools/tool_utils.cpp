@@ -0,0 +1,47 @@
+// Juliana Pacheco
+// University of Florida
+
+#include "src/tools/tool_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include "src/utils.h"
+
+namespace tools {
+
+  Counts read_counts(const std::string& filename) {
+    std::ifstream is(filename);
+    if(!is)
+      throw std::runtime_error("can't read '" + filename + '\'');
+    is.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // header
+
+    Counts counts;
+    std::unordered_map<std::string, std::size_t> index;
+    std::string line;
+    while(std::getline(is, line)) {
+      std::size_t comma = line.find(',');
+      if(line.empty() || comma == std::string::npos)
+        continue;
+      std::string word = utils::to_lower(line.substr(0, comma));
+      std::size_t count = std::stoull(line.substr(comma + 1));
+      auto entry = index.emplace(word, counts.size());
+      if(entry.second)
+        counts.emplace_back(word, count);
+      else
+        counts[entry.first->second].second += count;
+    }
+    return counts;
+  }
+
+  double percentile(const std::vector<double>& sorted, double p) {
+    if(sorted.empty())
+      return 0.0;
+    std::size_t rank = (std::size_t) std::ceil(p * sorted.size());
+    return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+  }
+
+} /* tools */
@@ -0,0 +1,28 @@
+// Juliana Pacheco
+// University of Florida
+
+#ifndef KEYBOARD_SWIPING_TOOL_UTILS_H
+#define KEYBOARD_SWIPING_TOOL_UTILS_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Input and statistics helpers shared by the tools, and by the benchmarks
+namespace tools {
+
+  typedef std::vector<std::pair<std::string, std::size_t>> Counts;
+
+  // Lower case words of a word,count CSV with a header line, such as
+  //  rcs/unigram_freq.csv, in file order. Counts are summed per word, as
+  //  read_file_with_frequency does. Throws std::runtime_error if the file
+  //  can't be read.
+  Counts read_counts(const std::string& filename);
+
+  // Nearest-rank percentile `p` (0 to 1) of ascending `sorted`, 0 if empty
+  double percentile(const std::vector<double>& sorted, double p);
+
+} /* tools */
+
+#endif /* end of include guard: KEYBOARD_SWIPING_TOOL_UTILS_H */
@@ -3,13 +3,14 @@
 
 #include "src/trie.h"
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <functional>
 #include <limits>
 #include <sstream>
-#include <stack>
 #include <utility>
+#include <vector>
 #include "utils.h"
 
 using Node = Trie::Node;
@@ -27,38 +28,82 @@ bool is_allowable(char c) {
       || utils::contains(ALLOWED_CHAR_S, c);
 }
 
-std::pair<bool,char> find_key(const Node& node, const Node* child) {
-  char key = 0;
-  bool result = node.do_on_children_while([&](char c, const Node* n) -> bool {
-    if(child == n) {
-      key = c;
-      return true;
-    }
-    return false;
-  });
-  return { result, key };
+// Path of `word` in the trie, as walked by `Trie::insert`
+std::string collapsed_key(const std::string& word) {
+  std::string key;
+  char prev_c = (char) 0;
+  for(char c : word) {
+    if(!std::isalpha((unsigned char) c) || prev_c == c)
+      continue;
+    c = std::tolower((unsigned char) c);
+    key += c;
+    prev_c = c;
+  }
+  return key;
+}
+
+// (key, index) of every valid word, sorted by key; ties keep input order
+std::vector<std::pair<std::string, std::size_t>>
+sorted_keys(const std::vector<std::string>& words) {
+  std::vector<std::pair<std::string, std::size_t>> keys;
+  keys.reserve(words.size());
+  for(std::size_t i = 0; i < words.size(); i++)
+    if(Trie::word_is_valid(words[i]))
+      keys.emplace_back(collapsed_key(words[i]), i);
+  if(!std::is_sorted(keys.cbegin(), keys.cend()))
+    std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+std::size_t common_prefix(const std::string& lhs, const std::string& rhs) {
+  std::size_t common = 0;
+  while(common < lhs.size() && common < rhs.size() && lhs[common] == rhs[common])
+    common++;
+  return common;
 }
 
 } /* anonymous */
 
-Trie::Trie() : size_(0) {
+template <class NodeT, class Func>
+NodeT* Trie::find_common(NodeT* root, const std::string& word, Func&& func) {
+  if(!word_is_valid(word))
+    return nullptr;
+
+  NodeT* current = root;
+  char prev_c = (char) 0;
+  for(char c : word) {
+    if(std::isalpha((unsigned char) c) && prev_c != c) {
+      c = std::tolower((unsigned char) c);
+      NodeT* child = current->get_child(c);
+      if(child == nullptr)
+        return nullptr;
+      func(current, c);
+      current = child;
+      prev_c = c;
+    }
+  }
+  return current;
+}
+
+Trie::Trie() : size_(0), pool_(std::make_shared<StringPool>()) {
   root_ = new Node();
 }
 
-Trie::Trie(const Trie& rhs) : Trie() {
-  *this = rhs;
+Trie::Trie(const Trie& rhs)
+      : root_(Node::acquire(rhs.root_)), size_(rhs.size_), pool_(rhs.pool_) {
 }
 
 Trie& Trie::operator=(const Trie& rhs) {
-  clear();
-  *root_ = *rhs.root_;
+  Node* old_root = root_;
+  root_ = Node::acquire(rhs.root_);
   size_ = rhs.size_;
+  pool_ = rhs.pool_;
+  Node::release(old_root);
   return *this;
 }
 
 Trie::~Trie() {
-  if(root_ != nullptr)
-    delete root_;
+  Node::release(root_);
 }
 
 bool Trie::empty() const { return size_ == 0; }
@@ -67,67 +112,138 @@ Trie::size_type Trie::size() const { return size_; }
 
 void Trie::clear() {
   size_ = 0;
-  if(root_ != nullptr)
-    delete root_;
+  Node::release(root_);
   root_ = new Node();
+  pool_ = std::make_shared<StringPool>();
+}
+
+void Trie::assign(const std::vector<std::string>& words) {
+  const auto keys = sorted_keys(words);
+
+  clear();
+  std::size_t bytes = 0;
+  for(auto& entry : keys)
+    bytes += words[entry.second].size();
+  pool_->reserve(bytes); // all words back to back
+  // path[i] is the node at depth i of the previous key
+  std::vector<Node*> path(1, root_);
+  const std::string* prev_key = nullptr;
+  for(std::size_t k = 0; k < keys.size(); k++) {
+    const std::string& key = keys[k].first;
+    const std::string& word = words[keys[k].second];
+    // A repeated word has the same key, so it comes soon after the first
+    bool repeated = false;
+    for(std::size_t j = k; j-- > 0 && keys[j].first == key && !repeated;)
+      repeated = words[keys[j].second] == word;
+    if(repeated)
+      continue;
+
+    std::size_t common = prev_key != nullptr ? common_prefix(*prev_key, key) : 0;
+    path.resize(common + 1);
+
+    // Keys are sorted, so new children always go after their siblings
+    for(std::size_t i = common; i < key.size(); i++) {
+      Node* parent = path.back();
+      Node* child = new Node();
+      parent->children_.emplace_hint(parent->children_.end(), key[i], child);
+      path.push_back(child);
+    }
+    path.back()->insert_word(pool_->add(word));
+    size_++;
+    prev_key = &key;
+  }
 }
 
 Trie::iterator Trie::insert(const std::string& word) {
   if(!word_is_valid(word))
     return end();
 
-  Node* current = root_;
+  Node* current = mutable_root();
   char prev_c = (char) 0;
   for(char c : word) {
     if(!std::isalpha((unsigned char) c) || prev_c == c)
       continue;
     c = std::tolower((unsigned char) c);
-    if(current->contains_child(c))
-      current = current->get_child(c);
-    else
-      current = current->insert_child(c);
+    current = current->insert_child(c);
     prev_c = c;
   }
   size_++;
-  current->insert_word(word);
+  current->insert_word(pool_->add(word));
   return iterator(current);
 }
 
 Trie::iterator Trie::erase(const std::string& word) {
-  std::stack<Node*> path;
-  iterator match = const_cast<Node*>(find_common(word, [&](const Node* n) {
-      path.push(const_cast<Node*>(n));
-    }
-  ).operator->());
-  path.push(match.operator->());
-
-  if(match != end()) {
-    match->remove_word(word);
-    size_--;
-    if(match->has_words() || match->has_children())
-      return match;
-
-    // delete empty nodes to root
-    while(!path.empty()&& !path.top()->has_words() && !path.top()->has_children()) {
-      Node* to_del = path.top();
-      path.pop();
-      if(to_del == root_ || path.empty()) break; // don't delete root
-      Node* parent = path.top();
-      std::pair<bool,char> key = find_key(*parent, to_del);
-      if(key.first)
-        parent->remove_child(key.second);
-    }
+  // Each parent is recorded with the letter leading out of it, so empty
+  //  nodes can be unlinked without searching their parent
+  std::vector<std::pair<Node*,char>> path;
+  Node* match = find_common(mutable_root(), word, [&path](Node* n, char c) {
+    path.emplace_back(n, c);
+  });
+  if(match == nullptr || !match->remove_word(word))
+    return end();
+
+  size_--;
+  if(match->has_words() || match->has_children())
+    return iterator(match);
+
+  // delete empty nodes up to (not including) the root
+  Node* node = match;
+  while(!path.empty() && !node->has_words() && !node->has_children()) {
+    path.back().first->remove_child(path.back().second);
+    node = path.back().first;
+    path.pop_back();
   }
   return end();
 }
 
+Trie::size_type Trie::erase_all(const std::vector<std::string>& words) {
+  const auto keys = sorted_keys(words);
+  size_type erased = 0;
+
+  // (node, letter leading to it) along the key of the previous word
+  std::vector<std::pair<Node*,char>> path(1, { mutable_root(), (char) 0 });
+  std::string path_key;
+  auto pop = [&path]() {
+    Node* node = path.back().first;
+    char c = path.back().second;
+    path.pop_back();
+    if(!node->has_words() && !node->has_children())
+      path.back().first->remove_child(c);
+  };
+
+  for(const auto& entry : keys) {
+    const std::string& key = entry.first;
+    std::size_t common = common_prefix(path_key, key);
+    while(path.size() > common + 1)
+      pop();
+    path_key.resize(common);
+
+    bool found = true;
+    for(std::size_t i = common; i < key.size() && found; i++) {
+      Node* child = path.back().first->get_child(key[i]);
+      if(child == nullptr) {
+        found = false;
+      } else {
+        path.emplace_back(child, key[i]);
+        path_key += key[i];
+      }
+    }
+    if(found && path.back().first->remove_word(words[entry.second]))
+      erased++;
+  }
+  while(path.size() > 1)
+    pop();
+
+  size_ -= erased;
+  return erased;
+}
+
 Trie::const_iterator Trie::find(const std::string& word) const {
-  return find_common(word, [](const Node*) {});
+  return find_common(static_cast<const Node*>(root_), word, [](const Node*, char) {});
 }
 
 Trie::iterator Trie::find(const std::string& word) {
-  const_iterator result = static_cast<const Trie&>(*this).find(word);
-  return const_cast<Node*>(result.operator->());
+  return find_common(mutable_root(), word, [](Node*, char) {});
 }
 
 bool Trie::contains(const std::string& word) const {
@@ -137,6 +253,10 @@ bool Trie::contains(const std::string& word) const {
   return result->contains_word(word);
 }
 
+Node* Trie::mutable_root() {
+  return Node::unshare(root_);
+}
+
 bool Trie::word_is_valid(const std::string& word) {
   for(char c : word) {
     if(!std::isalpha((unsigned char) c) && !is_allowable(c))
@@ -145,54 +265,126 @@ bool Trie::word_is_valid(const std::string& word) {
   return true;
 }
 
-Trie::const_iterator Trie::find_common(const std::string& word, std::function<void(const Node*)> func) const {
-  if(!word_is_valid(word))
-    return cend();
-
-  Node* current = root_;
+// Follows the letters as Trie::insert does: a letter repeats the previous
+//  one only if it is already lower case
+Trie::Runs Trie::runs_of(std::string_view word) {
+  const int max_position = 16;
+  Runs runs;
+  int position = -1;
+  bool repeated = false;
   char prev_c = (char) 0;
   for(char c : word) {
-    if(std::isalpha((unsigned char) c) && prev_c != c) {
-      c = std::tolower((unsigned char) c);
-      if(current->get_child(c) == nullptr)
-        return cend();
-      func(current);
-      current = current->get_child(c);
-      prev_c = c;
+    if(!std::isalpha((unsigned char) c))
+      continue;
+    if(prev_c == c) {
+      repeated = true;
+      continue;
     }
+    if(position >= 0 && position < max_position)
+      (repeated ? runs.doubled : runs.single) |= 1u << position;
+    position++;
+    repeated = false;
+    prev_c = std::tolower((unsigned char) c);
   }
-  return const_iterator(current);
+  if(position >= 0 && position < max_position)
+    (repeated ? runs.doubled : runs.single) |= 1u << position;
+  return runs;
 }
 
 Node::Node(const Node& rhs) : Node() { *this = rhs; }
 
 Node& Node::operator=(const Node& rhs) {
+  if(this == &rhs)
+    return *this;
   words_ = rhs.words_;
+  ranks_ = rhs.ranks_;
   clear_children();
-  rhs.do_on_children([this](char c, const Node* rhs_child) {
-    if(rhs_child == nullptr)
-      return;
-    Node* new_child = insert_child(c);
-    *new_child = *rhs_child;
-  });
+  // Keys arrive sorted, so every child is appended at the end of the map
+  for(auto cit = rhs.children_.cbegin(); cit != rhs.children_.cend(); ++cit)
+    if(cit->second != nullptr)
+      children_.emplace_hint(children_.end(), cit->first, acquire(cit->second));
   return *this;
 }
 
 Node::~Node() {
-  delete_children();
+  release_children();
 }
 
-bool Node::contains_word(const std::string& word) const {
-  return utils::contains(words_, word);
+bool Node::contains_word(std::string_view word) const {
+  return std::find(words_.cbegin(), words_.cend(), word) != words_.cend();
 }
 
-void Node::remove_word(const std::string& word) {
-  for(auto it = words_.begin(); it != words_.end(); ++it) {
-    if(*it == word) {
-      words_.erase(it);
-      return;
+void Node::insert_word(std::string_view word, rank_type rank) {
+  words_.push_back(word);
+  ranks_.push_back(rank);
+  invalidate();
+}
+
+bool Node::remove_word(std::string_view word) {
+  for(std::size_t i = 0; i < words_.size(); i++) {
+    if(words_[i] == word) {
+      words_.erase(words_.begin() + i);
+      ranks_.erase(ranks_.begin() + i);
+      invalidate();
+      return true;
     }
   }
+  return false;
+}
+
+Trie::rank_type Node::get_rank(std::string_view word) const {
+  for(std::size_t i = 0; i < words_.size(); i++)
+    if(words_[i] == word)
+      return ranks_[i];
+  return 0;
+}
+
+bool Node::set_rank(std::string_view word, rank_type rank) {
+  for(std::size_t i = 0; i < words_.size(); i++) {
+    if(words_[i] == word) {
+      ranks_[i] = rank;
+      invalidate();
+      return true;
+    }
+  }
+  return false;
+}
+
+Trie::rank_type Node::best_rank() const {
+  std::uint32_t best = best_.load(std::memory_order_acquire);
+  if(best == 0) {
+    summarise();
+    best = best_.load(std::memory_order_acquire);
+  }
+  return best - 1;
+}
+
+Trie::Runs Node::runs() const {
+  if(best_.load(std::memory_order_acquire) == 0)
+    summarise();
+  std::uint32_t runs = runs_.load(std::memory_order_relaxed);
+  return { (std::uint16_t) (runs >> 16), (std::uint16_t) runs };
+}
+
+// Concurrent callers may both compute the values; they store the same ones.
+//  best_ is stored last, so whoever reads it set also reads runs_ set.
+void Node::summarise() const {
+  rank_type rank = 0;
+  Runs runs;
+  for(std::size_t i = 0; i < words_.size(); i++) {
+    rank = std::max(rank, ranks_[i]);
+    Runs word = Trie::runs_of(words_[i]);
+    runs.doubled |= word.doubled;
+    runs.single |= word.single;
+  }
+  for(auto cit = children_.cbegin(); cit != children_.cend(); ++cit) {
+    rank = std::max(rank, cit->second->best_rank());
+    Runs child = cit->second->runs();
+    runs.doubled |= child.doubled;
+    runs.single |= child.single;
+  }
+  runs_.store((std::uint32_t) runs.doubled << 16 | runs.single, std::memory_order_relaxed);
+  best_.store(rank + 1u, std::memory_order_release);
 }
 
 bool Node::contains_child(char c) const {
@@ -201,12 +393,13 @@ bool Node::contains_child(char c) const {
 }
 
 const Node* Node::get_child(char c) const {
-  c = std::tolower((unsigned char) c);
-  return contains_child(c) ? children_.at(c) : nullptr;
+  auto child = children_.find(std::tolower((unsigned char) c));
+  return child != children_.cend() ? child->second : nullptr;
 }
 
 Node* Node::get_child(char c) {
-  return const_cast<Node*>(static_cast<const Node&>(*this).get_child(c));
+  auto child = children_.find(std::tolower((unsigned char) c));
+  return child != children_.end() ? unshare(child->second) : nullptr;
 }
 
 Node* Node::insert_child(char c) {
@@ -216,6 +409,7 @@ Node* Node::insert_child(char c) {
   if(child == nullptr) {
     child = new Node();
     children_[c] = child;
+    invalidate();
   }
   return child;
 }
@@ -223,39 +417,50 @@ Node* Node::insert_child(char c) {
 void Node::remove_child(char c) {
   auto child = children_.find(c);
   if(child != children_.end()) {
-    if(child->second != nullptr)
-      delete child->second;
+    release(child->second);
     children_.erase(child);
+    invalidate();
   }
 }
 
-void Node::do_on_children(const std::function<void(char,const Node*)>& func) const {
-  for(auto cit = children_.cbegin(); cit != children_.cend(); ++cit)
-    func(cit->first, cit->second);
+Node* Node::acquire(Node* node) {
+  if(node != nullptr)
+    node->refs_.fetch_add(1, std::memory_order_relaxed);
+  return node;
 }
 
-bool Node::do_on_children_while(const std::function<bool(char,const Node*)>& func) const {
-  for(auto cit = children_.cbegin(); cit != children_.cend(); ++cit)
-    if(func(cit->first, cit->second))
-      return true;
-  return false;
+void Node::release(Node* node) {
+  if(node != nullptr && node->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete node;
 }
 
-void Node::do_on_children(const std::function<void(char,Node*)>& func) {
-  for(auto it = children_.begin(); it != children_.end(); ++it)
-    func(it->first, it->second);
+Node* Node::unshare(Node*& slot) {
+  if(slot != nullptr && slot->is_shared()) {
+    Node* copy = new Node(*slot);
+    release(slot);
+    slot = copy;
+  }
+  if(slot != nullptr)
+    slot->invalidate();
+  return slot;
 }
 
-void Node::delete_children() {
-  do_on_children([](char, Node* child) {
-    if(child != nullptr)
-    delete child;
-  });
+void Node::release_children() {
+  for(auto it = children_.begin(); it != children_.end(); ++it)
+    release(it->second);
 }
 
 void read_from_file(Trie& trie, const char* filename) {
   std::ifstream is(filename);
-  while(is >> trie);
+  if(trie.empty()) {
+    std::vector<std::string> words;
+    std::string word;
+    while(is >> word)
+      words.push_back(word);
+    trie.assign(words);
+  } else {
+    while(is >> trie);
+  }
   is.close();
 }
 
@@ -263,6 +468,20 @@ void read_from_file(Trie& trie, const std::string& filename) {
   read_from_file(trie, filename.c_str());
 }
 
+Trie::size_type erase_from_file(Trie& trie, const char* filename) {
+  std::ifstream is(filename);
+  std::vector<std::string> words;
+  std::string word;
+  while(is >> word)
+    words.push_back(word);
+  is.close();
+  return trie.erase_all(words);
+}
+
+Trie::size_type erase_from_file(Trie& trie, const std::string& filename) {
+  return erase_from_file(trie, filename.c_str());
+}
+
 void read_file_with_frequency(Trie& trie,
       std::unordered_map<std::string,std::size_t>& map,
       const char* filename,
@@ -275,6 +494,10 @@ void read_file_with_frequency(Trie& trie,
   if(has_header)
     is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
+  // An empty trie is built in bulk once every word is known
+  const bool bulk = trie.empty();
+  std::vector<std::string> words;
+
   while(std::getline(is, line)) {
     if(line.empty())
       continue;
@@ -282,12 +505,19 @@ void read_file_with_frequency(Trie& trie,
 
     std::getline(ls, word, separator);
     utils::to_lower(word);
-    trie.insert(word);
-
     std::getline(ls, freq);
-    map[word] += std::stoul(freq);
+    std::size_t count = std::stoul(freq);
+
+    if(bulk)
+      words.push_back(word);
+    else if(!trie.contains(word))
+      trie.insert(word);
+    map[word] += count;
   }
   is.close();
+
+  if(bulk)
+    trie.assign(words);
 }
 
 void read_file_with_frequency(Trie& trie,
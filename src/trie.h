@@ -4,12 +4,18 @@
 #ifndef KEYBOARD_SWIPING_TRIE_H
 #define KEYBOARD_SWIPING_TRIE_H
 
-#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "src/string_pool.h"
 
 class Trie {
 protected:
@@ -39,11 +45,53 @@ protected:
     pointer ptr_;
   };
 
+  // Walks every node below (and including) a starting node, either depth
+  //  first in pre-order or breadth first. Children are visited in key order.
+  template <typename T, bool BreadthFirst>
+  class TraversalIterator {
+  public:
+    using value_type = T;
+    using pointer = T*;
+    using reference = T&;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    TraversalIterator(pointer ptr = nullptr) { if(ptr != nullptr) pending_.push_back(ptr); }
+
+    bool operator==(const TraversalIterator& rhs) const { return current() == rhs.current(); }
+    bool operator!=(const TraversalIterator& rhs) const { return current() != rhs.current(); }
+    reference operator*() const { return *current(); }
+    pointer operator->() const { return current(); }
+    TraversalIterator& operator++();
+    TraversalIterator operator++(int) { TraversalIterator old(*this); ++*this; return old; }
+
+  private:
+    pointer current() const {
+      if(pending_.empty())
+        return nullptr;
+      return BreadthFirst ? pending_.front() : pending_.back();
+    }
+
+    std::deque<pointer> pending_;
+  };
+
 public:
   class Node;
   typedef NodeIterator<Node> iterator;
   typedef NodeIterator<const Node> const_iterator;
+  typedef TraversalIterator<const Node, false> const_dfs_iterator;
+  typedef TraversalIterator<const Node, true> const_bfs_iterator;
   typedef std::size_t size_type;
+  // Quantised frequency kept next to each word (see utils::frequency_rank)
+  typedef std::uint16_t rank_type;
+  // Positions of a collapsed key that stand for a letter typed more than
+  //  once in a row (bits of `doubled`, e.g. bit 2 for the "ll" of "hello")
+  //  and for a letter typed once (bits of `single`). Positions from 16 on
+  //  aren't recorded.
+  struct Runs {
+    std::uint16_t doubled = 0;
+    std::uint16_t single = 0;
+  };
 
   Trie();
   Trie(const Trie& rhs);
@@ -53,28 +101,69 @@ public:
   bool empty() const;
   size_type size() const;
 
-  iterator begin() { return iterator(root_); }
+  iterator begin() { return iterator(mutable_root()); }
   const_iterator cbegin() const { return const_iterator(root_); }
   iterator end() { return iterator(); }
   const_iterator cend() const { return const_iterator(); }
+  const_dfs_iterator dfs_begin() const { return const_dfs_iterator(root_); }
+  const_dfs_iterator dfs_end() const { return const_dfs_iterator(); }
+  const_bfs_iterator bfs_begin() const { return const_bfs_iterator(root_); }
+  const_bfs_iterator bfs_end() const { return const_bfs_iterator(); }
 
   void clear();
+  // Replaces the contents with `words` in a single pass that creates nodes
+  //  in depth first order, keeping them close together in memory, and
+  //  copies the words into one contiguous block. Words are sorted by key
+  //  first unless they already are, and repeated ones are added once.
+  void assign(const std::vector<std::string>& words);
   iterator insert(const std::string& word);
   iterator erase(const std::string& word);
+  // Erases many words (e.g. a blocklist) in a single traversal of the
+  //  trie. Returns the number of words erased.
+  size_type erase_all(const std::vector<std::string>& words);
 
   const_iterator find(const std::string& word) const;
   iterator find(const std::string& word);
   bool contains(const std::string& word) const;
 
-private:
+  // Sets the rank of every word to `func(word, current_rank)`, in a single
+  //  pass over the trie. `word` is a std::string_view.
+  template <class Func> void rank_words(Func&& func);
+
   static bool word_is_valid(const std::string& word);
-  const_iterator find_common(const std::string& word,
-        std::function<void(const Node*)> func) const;
+  static Runs runs_of(std::string_view word);
+
+private:
+  // Walks the collapsed key of `word`, calling `func(node, letter)` on
+  //  every node left behind. Non-const nodes are unshared along the way.
+  template <class NodeT, class Func>
+  static NodeT* find_common(NodeT* root, const std::string& word, Func&& func);
+  Node* mutable_root();
 
   Node* root_;
   size_type size_;
+  // Holds the characters of every word, shared with copies of the trie.
+  //  Erased words keep their space until the trie is cleared or assigned.
+  std::shared_ptr<StringPool> pool_;
 };
 
+// Nodes are reference counted and shared between copies of a Trie, which
+//  makes copying O(1). Any node reached through a non-const accessor is
+//  first replaced by a private copy if it is shared (copy-on-write), so
+//  modifying one trie never shows through another. Copying a node shares
+//  its children in the same way. As with any copy-on-write container,
+//  non-const iterators obtained before the trie was copied must not be
+//  used to modify it afterwards.
+//
+// For prefix completion every node caches the best rank and the union of
+//  the Runs of the words below it. The cache is computed on first use and
+//  dropped whenever the node is reached through a non-const accessor, so
+//  changes made through a non-const iterator are only seen if no
+//  completion is asked for between obtaining the iterator and making the
+//  change.
+//
+// Words are views of characters owned by the trie's StringPool, so only
+//  the Trie adds them (see Trie::insert).
 class Trie::Node {
 public:
   Node() = default;
@@ -82,14 +171,24 @@ public:
   Node& operator=(const Node& rhs);
   ~Node();
 
+  bool is_shared() const { return refs_.load(std::memory_order_acquire) > 1; }
+
   void clear() { clear_words(); clear_children(); }
 
   bool has_words() const { return !words_.empty(); }
-  bool contains_word(const std::string& word) const;
-  void insert_word(const std::string& word) { words_.push_back(word); }
-  void remove_word(const std::string& word);
-  void clear_words() { words_.clear(); }
-  const std::vector<std::string>& get_words() const { return words_; }
+  bool contains_word(std::string_view word) const;
+  bool remove_word(std::string_view word);
+  void clear_words() { words_.clear(); ranks_.clear(); invalidate(); }
+  const std::vector<std::string_view>& get_words() const { return words_; }
+  // Parallel to `get_words`
+  const std::vector<rank_type>& get_ranks() const { return ranks_; }
+  rank_type get_rank(std::string_view word) const;
+  bool set_rank(std::string_view word, rank_type rank);
+  // Highest rank of the words in this node and below it, 0 if there are
+  //  none, and the union of their Runs. Safe to call from several threads
+  //  at once.
+  rank_type best_rank() const;
+  Runs runs() const;
 
   bool has_children() const { return !children_.empty(); }
   bool contains_child(char c) const;
@@ -97,23 +196,95 @@ public:
   Node* get_child(char c);
   Node* insert_child(char c);
   void remove_child(char c);
-  void clear_children() { delete_children(); children_.clear(); }
-  void do_on_children(const std::function<void(char,const Node*)>& func) const;
-  void do_on_children(const std::function<void(char,Node*)>& func);
-  bool do_on_children_while(const std::function<bool(char,const Node*)>& func) const;
+  void clear_children() { release_children(); children_.clear(); invalidate(); }
+  // Visitors are templates rather than std::function so they inline
+  template <class Func> void do_on_children(Func&& func) const;
+  template <class Func> void do_on_children(Func&& func);
+  // Stops and returns true as soon as `func` does
+  template <class Func> bool do_on_children_while(Func&& func) const;
 
 private:
-  void delete_children();
+  friend class Trie;
+
+  static Node* acquire(Node* node);
+  static void release(Node* node);
+  // Makes `slot` point to a node owned by this trie alone
+  static Node* unshare(Node*& slot);
+  void release_children();
+  // `word` must be owned by the trie's StringPool
+  void insert_word(std::string_view word, rank_type rank = 0);
+  void invalidate() { best_.store(0, std::memory_order_relaxed); }
+  void summarise() const;
 
-  std::vector<std::string> words_;
+  std::vector<std::string_view> words_;
+  std::vector<rank_type> ranks_;
   std::map<char,Node*> children_;
+  std::atomic<std::size_t> refs_{1};
+  // best_rank() + 1, or 0 when it and runs_ have to be computed again
+  mutable std::atomic<std::uint32_t> best_{0};
+  mutable std::atomic<std::uint32_t> runs_{0};
 };
 
+template <class Func>
+void Trie::Node::do_on_children(Func&& func) const {
+  for(auto cit = children_.cbegin(); cit != children_.cend(); ++cit)
+    func(cit->first, static_cast<const Node*>(cit->second));
+}
+
+template <class Func>
+void Trie::Node::do_on_children(Func&& func) {
+  for(auto it = children_.begin(); it != children_.end(); ++it)
+    func(it->first, unshare(it->second));
+}
+
+template <class Func>
+bool Trie::Node::do_on_children_while(Func&& func) const {
+  for(auto cit = children_.cbegin(); cit != children_.cend(); ++cit)
+    if(func(cit->first, static_cast<const Node*>(cit->second)))
+      return true;
+  return false;
+}
+
+template <class Func>
+void Trie::rank_words(Func&& func) {
+  std::vector<Node*> pending(1, mutable_root());
+  while(!pending.empty()) {
+    Node* node = pending.back();
+    pending.pop_back();
+    for(std::size_t i = 0; i < node->words_.size(); i++)
+      node->ranks_[i] = func(node->words_[i], node->ranks_[i]);
+    node->do_on_children([&pending](char, Node* child) { pending.push_back(child); });
+  }
+}
+
+template <typename T, bool BreadthFirst>
+Trie::TraversalIterator<T, BreadthFirst>&
+Trie::TraversalIterator<T, BreadthFirst>::operator++() {
+  pointer node = current();
+  if(node == nullptr)
+    return *this;
+
+  if(BreadthFirst) {
+    pending_.pop_front();
+    node->do_on_children([this](char, pointer child) { pending_.push_back(child); });
+  } else {
+    pending_.pop_back();
+    // Pushed in reverse so the smallest key is visited first
+    std::size_t at = pending_.size();
+    node->do_on_children([this, at](char, pointer child) {
+      pending_.insert(pending_.begin() + at, child);
+    });
+  }
+  return *this;
+}
+
 
 // Note: These functions don't internally handle any possible exception.
 //  Calls to these functions should be contained in a try-catch block
 void read_from_file(Trie& trie, const char* filename);
 void read_from_file(Trie& trie, const std::string& filename);
+Trie::size_type erase_from_file(Trie& trie, const char* filename);
+Trie::size_type erase_from_file(Trie& trie, const std::string& filename);
 void read_file_with_frequency(Trie& trie,
       std::unordered_map<std::string,std::size_t>& map,
       const char* filename,
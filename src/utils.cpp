@@ -3,8 +3,12 @@
 
 #include "src/utils.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <string_view>
 
 namespace utils {
 
@@ -14,10 +18,29 @@ namespace utils {
   }
 
   std::string to_lower(const std::string& str) {
+    return to_lower(std::string_view(str));
+  }
+
+  std::string to_lower(std::string_view str) {
     std::string result;
+    result.reserve(str.size());
     for(char c : str)
       result += (unsigned char) std::tolower((unsigned char) c);
     return result;
   }
 
+  namespace {
+    const double RANK_STEPS = 1024.0; // per doubling
+    const std::uint16_t MAX_RANK = std::numeric_limits<std::uint16_t>::max();
+  } /* anonymous */
+
+  std::uint16_t frequency_rank(std::uint64_t count) {
+    double rank = std::round(std::log2((double) count + 1.0) * RANK_STEPS);
+    return (std::uint16_t) std::min(rank, (double) MAX_RANK);
+  }
+
+  std::uint64_t rank_frequency(std::uint16_t rank) {
+    return (std::uint64_t) std::round(std::exp2(rank / RANK_STEPS) - 1.0);
+  }
+
 } /* utils */
@@ -4,13 +4,23 @@
 #ifndef KEYBOARD_SWIPING_UTILS_H
 #define KEYBOARD_SWIPING_UTILS_H
 
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <string_view>
 
 namespace utils {
 
   void to_lower(std::string& str);
   std::string to_lower(const std::string& str);
+  std::string to_lower(std::string_view str);
+
+  // 16-bit log-quantised word frequency, 1024 steps per doubling (about
+  //  0.07% apart). Ranks keep the order of counts, except that counts
+  //  closer than one step may share a rank.
+  std::uint16_t frequency_rank(std::uint64_t count);
+  // Approximate count of a word of rank `rank`
+  std::uint64_t rank_frequency(std::uint16_t rank);
 
   template <typename T, class Container, class Compare>
   bool contains(const Container& cont, const T& value, const Compare& comp) {